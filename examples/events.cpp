@@ -0,0 +1,56 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "LedWriter.h"
+
+LedWriter<3> writer(std::array<uint8_t, 3>{15, 13, 12}, 10, false);
+uint32_t fades = 0;
+
+void onDrained(const EffectEvent<3>& event, void* context)
+{
+    // Queues the next fade the moment the last one finishes; no polling
+    uint32_t* count = static_cast<uint32_t*>(context);
+    uint16_t level = ((++(*count) % 2) ? 1023 : 0);
+    event.writer->createEffect({level, 0, static_cast<uint16_t>(1023 - level)}, 1.5);
+}
+
+void onHold(const EffectEvent<3>& event, void* context)
+{
+    Serial.printf("UID %u hold %s at %u us\n", event.uid,
+        ((event.type == EffectEvent<3>::HOLD_STARTED) ? "started" : "ended"), event.time);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    writer.listen(onDrained, &fades, EffectEvent<3>::DRAINED);
+    writer.listen(onHold, nullptr, (EffectEvent<3>::HOLD_STARTED | EffectEvent<3>::HOLD_ENDED));
+    writer.createEffect({1023, 1023, 1023}, 1)->hold(.5, .5);
+}
+
+void loop()
+{
+    writer.run(); // Listeners are called from here as effects change state
+}
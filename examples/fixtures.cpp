@@ -0,0 +1,48 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "FixtureManager.h"
+
+// Storage for every writer is reserved once, up front
+FixtureManager<3> fixtures(4);
+
+void setup()
+{
+    fixtures.add({15, 13, 12});
+    fixtures.add({14, 27, 26});
+    fixtures.add({25, 33, 32});
+    fixtures.add({23, 22, 21});
+    for (uint32_t i = 0; i < fixtures.size(); ++i) {
+        // Stagger a slow chase across the fixtures
+        fixtures[i].createEffect({1023, 0, 512}, 2, false, (i * 0.25), 0, 0, 0, false, -1);
+        fixtures[i].createEffect({0, 0, 0}, 2, false, 0, 0, 0, 0, false, -1);
+    }
+    fixtures.startTasks(); // Splits the fixtures across both cores on ESP32
+}
+
+void loop()
+{
+    fixtures.run(); // One clock read per frame for every fixture
+}
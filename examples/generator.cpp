@@ -0,0 +1,43 @@
+#include "LedWriter.h"
+
+std::array<uint8_t, 3> pins = {
+        15, // Red output pin
+        13, // Green output pin
+        12, // Blue output pin
+    };
+
+LedWriter<3> writer(
+        pins,
+        10, // Resolution (1-15); 10-bit allows a range of 0-1023
+        false // Whether to initialize output in constructor
+    );
+
+void setup()
+{
+    std::array<Oscillator, 3> oscillators;
+
+    // Red breathes slowly
+    oscillators[0].waveform = Generator<3>::SINE;
+    oscillators[0].frequency = .25; // Cycles per second
+    oscillators[0].amplitude = 1023; // Peak-to-peak output
+
+    // Green strobes with a 10% duty cycle
+    oscillators[1].waveform = Generator<3>::SQUARE;
+    oscillators[1].frequency = 4;
+    oscillators[1].amplitude = 512;
+    oscillators[1].duty = .1;
+
+    // Blue flickers around a constant glow
+    oscillators[2].waveform = Generator<3>::NOISE;
+    oscillators[2].frequency = 8;
+    oscillators[2].amplitude = 256;
+    oscillators[2].offset = 128; // Output at the bottom of each cycle
+
+    // Runs indefinitely in one queue slot until skipped or cleared
+    writer.createGenerator(oscillators);
+}
+
+void loop()
+{
+    writer.run(); // Required to process operations
+}
@@ -0,0 +1,47 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "PixelMap.h"
+
+// 16 x 16 matrix wired back and forth, driven by one pattern
+SpiSink sink(13);
+PixelStrip strip(256, PixelStrip::GRB, &sink);
+PixelMap map(256);
+Palette palette({{0, 0, 64, 0}, {255, 0, 128, 0}, {255, 200, 0, 0}});
+
+void setup()
+{
+    map.addGrid(16, 16, true);
+    map.pattern.type = PixelMap::PLASMA;
+    map.pattern.scale = 1.5;
+    map.pattern.speed = .2; // Cycles per second
+}
+
+void loop()
+{
+    map.evaluate(micros());
+    map.render(strip, palette);
+    strip.show();
+}
@@ -0,0 +1,45 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "PixelStrip.h"
+
+SpiSink sink(13); // WS2812 data on the SPI MOSI pin
+PixelStrip strip(300, PixelStrip::GRB, &sink);
+
+void setup()
+{
+    // Three segments fade independently, each from its own start
+    strip.createEffect({255, 0, 0, 0}, 0, 100, 1);
+    strip.createEffect({0, 255, 0, 0}, 100, 100, 1, .5, Easing::get(Easing::EASE_IN_OUT));
+    strip.createEffect({0, 0, 255, 0}, 200, 100, 2, 1, Easing::get(Easing::CUBIC_OUT));
+}
+
+void loop()
+{
+    strip.run(); // Steps effects and sends the frame
+    if (!strip.effectsQueued()) {
+        strip.createEffect({0, 0, 0, 0}, 0, 0, 3); // Whole strip to black
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <WiFi.h>
+#include "TimecodeChase.h"
+
+LedWriter<3> writer(std::array<uint8_t, 3>{15, 13, 12}, 10, false);
+TimecodeReceiver timecode; // MIDI timecode bytes in UDP datagrams
+TimecodeChase<3> chase(&writer, &timecode);
+
+void setup()
+{
+    WiFi.begin("network", "password");
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        delay(100);
+    }
+    timecode.begin(TIMECODE_PORT);
+    timecode.freewheel = 250000; // Stop a quarter second after timecode does
+
+    // Red to green to blue, starting 10 seconds into the show
+    chase.addTimeline({
+            {500000, {1023, 0, 0}, nullptr},
+            {3000000, {0, 1023, 0}, Easing::get(Easing::EASE_IN_OUT)},
+            {6000000, {0, 0, 1023}, nullptr}
+        }, 10);
+
+    // A slow red pulse from 00:01:00:00 until the show ends
+    std::array<Oscillator, 3> pulse;
+    pulse[0].frequency = .25;
+    pulse[0].amplitude = 1023;
+    chase.addGenerator(pulse, 60);
+}
+
+void loop()
+{
+    chase.run(); // Follows play, stop, locate and scrub; writer.run() is not needed
+}
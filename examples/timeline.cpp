@@ -0,0 +1,43 @@
+#include "LedWriter.h"
+
+std::array<uint8_t, 3> pins = {
+        15, // Red output pin
+        13, // Green output pin
+        12, // Blue output pin
+    };
+
+LedWriter<3> writer(
+        pins,
+        10, // Resolution (1-15); 10-bit allows a range of 0-1023
+        false // Whether to initialize output in constructor
+    );
+
+void setup()
+{
+    // A 100-step chase occupies a single queue slot
+    std::vector<Keyframe<3>> keyframes;
+    keyframes.reserve(100);
+    for (uint32_t i = 1; i <= 100; ++i)
+    {
+        keyframes.push_back({
+                i * 50000, // Microseconds from start of timeline
+                std::array<uint16_t, 3>{
+                        static_cast<uint16_t>(i % 2 ? 1023 : 0),
+                        static_cast<uint16_t>(i * 10),
+                        static_cast<uint16_t>(1000 - (i * 10))
+                    },
+                Easing::get(Easing::EASE_IN_OUT) // Curve into this keyframe
+            });
+    }
+    writer.createTimeline(
+            keyframes,
+            0.0, // Start immediately (0 seconds from now)
+            0, // Unique effect ID
+            -1 // Loop indefinitely
+        );
+}
+
+void loop()
+{
+    writer.run(); // Required to process operations
+}
@@ -0,0 +1,321 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ClockSync.h"
+#include <string.h>
+#include <algorithm>
+
+#if ESP32
+    #include <esp_timer.h>
+#elif !defined(IS_EMBEDDED)
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #include <chrono>
+#endif
+
+static const uint8_t syncMagic[4] = {'L', 'W', 'C', 'S'};
+
+enum SyncMessage : uint8_t {SYNC_REQUEST = 1, SYNC_REPLY = 2};
+
+int64_t DisciplinedClock::at(uint64_t local) {
+    // Network time corresponding to a local reading
+    int64_t elapsed = static_cast<int64_t>(local - this->reference);
+    return (this->base + static_cast<int64_t>(elapsed * this->rate));
+}
+
+void DisciplinedClock::discipline(uint64_t local, int64_t offset) {
+    /* offset is network minus local time, measured at local. Large
+    errors step; smaller ones are slewed out over CLOCK_SLEW_TIME. */
+    int64_t measured = (static_cast<int64_t>(local) + offset);
+    if (!this->synchronized) {
+        this->base = measured;
+        this->reference = local;
+        this->lastLocal = local;
+        this->lastOffset = offset;
+        this->rate = 1;
+        this->synchronized = true;
+        return;
+    }
+    if ((local - this->lastLocal) >= CLOCK_DRIFT_SPAN) {
+        double observed = (static_cast<double>(offset - this->lastOffset) / (local - this->lastLocal));
+        this->drift = (this->driftKnown ? (this->drift + ((observed - this->drift) * .5)) : observed);
+        this->driftKnown = true;
+        this->lastLocal = local;
+        this->lastOffset = offset;
+    }
+    int64_t estimate = at(local);
+    int64_t error = (measured - estimate);
+    if ((error > CLOCK_STEP_THRESHOLD) || (error < -CLOCK_STEP_THRESHOLD)) {
+        this->base = measured;
+        this->slew = 0;
+    } else {
+        this->base = estimate;
+        this->slew = std::max(-CLOCK_MAX_SLEW, std::min(CLOCK_MAX_SLEW, (error / (CLOCK_SLEW_TIME * 1e6))));
+    }
+    this->reference = local;
+    this->rate = (1 + this->drift + this->slew);
+}
+
+void DisciplinedClock::reset() {
+    this->synchronized = false;
+    this->driftKnown = false;
+    this->rate = 1;
+    this->drift = 0;
+    this->slew = 0;
+}
+
+ClockSync::ClockSync(uint8_t role, LocalClock local) {
+    this->role = role;
+    this->local = ((local != nullptr) ? local : localMicros);
+    if (role == MASTER) {
+        // The master's own clock defines network time
+        this->clock.discipline(this->local(), 0);
+    }
+}
+
+ClockSync::~ClockSync() {
+    end();
+}
+
+uint64_t ClockSync::localMicros() {
+    #if ESP32
+        return esp_timer_get_time();
+    #elif defined(IS_EMBEDDED)
+        // Extends the 32-bit counter; needs a call at least every 71 minutes
+        static uint64_t extended = 0;
+        static uint32_t previous = 0;
+        uint32_t current = micros();
+        extended += (current - previous);
+        previous = current;
+        return extended;
+    #else
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+    #endif
+}
+
+uint64_t ClockSync::now() {
+    return static_cast<uint64_t>(this->clock.at(this->local()));
+}
+
+uint32_t ClockSync::now32() {
+    // For LedWriter::run(); every node wraps at the same instant
+    return static_cast<uint32_t>(now());
+}
+
+bool ClockSync::synchronized() {
+    return this->clock.synchronized;
+}
+
+void ClockSync::encode64(uint8_t* bytes, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = ((value >> (i * 8)) & 0xFF);
+    }
+}
+
+uint64_t ClockSync::decode64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = ((value << 8) | bytes[i]);
+    }
+    return value;
+}
+
+size_t ClockSync::request(uint8_t* packet, uint64_t sent) {
+    memset(packet, 0, CLOCK_SYNC_SIZE);
+    memcpy(packet, syncMagic, sizeof(syncMagic));
+    packet[4] = SYNC_REQUEST;
+    encode64((packet + 8), sent);
+    return CLOCK_SYNC_SIZE;
+}
+
+size_t ClockSync::respond(const uint8_t* packet, size_t size, uint8_t* reply, uint64_t arrival) {
+    // Echoes t1 and adds the master's receive and transmit times
+    if ((size < CLOCK_SYNC_SIZE) || memcmp(packet, syncMagic, sizeof(syncMagic)) || (packet[4] != SYNC_REQUEST)) {
+        this->rejected++;
+        return 0;
+    }
+    memcpy(reply, packet, CLOCK_SYNC_SIZE);
+    reply[4] = SYNC_REPLY;
+    encode64((reply + 16), this->clock.at(arrival));
+    encode64((reply + 24), now());
+    this->exchanges++;
+    return CLOCK_SYNC_SIZE;
+}
+
+bool ClockSync::receive(const uint8_t* packet, size_t size, uint64_t arrival) {
+    if ((size < CLOCK_SYNC_SIZE) || memcmp(packet, syncMagic, sizeof(syncMagic)) || (packet[4] != SYNC_REPLY)) {
+        this->rejected++;
+        return false;
+    }
+    uint64_t t1 = decode64(packet + 8);
+    int64_t t2 = decode64(packet + 16), t3 = decode64(packet + 24);
+    if ((t1 != this->pending) || (arrival < t1)) {
+        // Stale or duplicate reply
+        this->rejected++;
+        return false;
+    }
+    this->pending = 0;
+    Sample& sample = this->samples[this->exchanges % CLOCK_FILTER_SIZE];
+    sample.local = (t1 + ((arrival - t1) / 2));
+    sample.offset = (((t2 - static_cast<int64_t>(t1)) + (t3 - static_cast<int64_t>(arrival))) / 2);
+    sample.delay = ((arrival - t1) - (t3 - t2));
+    this->exchanges++;
+    filter();
+    return true;
+}
+
+void ClockSync::filter() {
+    // Least delay means least queueing asymmetry, so the truest offset
+    uint32_t count = std::min<uint32_t>(this->exchanges, CLOCK_FILTER_SIZE);
+    const Sample* best = &this->samples[0];
+    for (uint32_t i = 1; i < count; ++i) {
+        if (this->samples[i].delay < best->delay) {
+            best = &this->samples[i];
+        }
+    }
+    this->offset = best->offset;
+    this->delay = best->delay;
+    // Projected to the newest exchange so the clock sees current time
+    const Sample& newest = this->samples[(this->exchanges - 1) % CLOCK_FILTER_SIZE];
+    int64_t projected = (best->offset + static_cast<int64_t>((static_cast<int64_t>(newest.local - best->local)) * this->clock.drift));
+    this->clock.discipline(newest.local, projected);
+}
+
+bool ClockSync::begin(uint16_t port, const char* master) {
+    /* Masters listen on port; followers poll the master at that port.
+    Without a master address, followers broadcast requests. */
+    this->port = port;
+    #if ESP32
+        if (this->role == FOLLOWER) {
+            if (master != nullptr) {
+                this->master.fromString(master);
+            } else {
+                this->master = IPAddress(255, 255, 255, 255);
+            }
+            return this->udp.begin(0);
+        }
+        return this->udp.begin(port);
+    #elif !defined(IS_EMBEDDED)
+        end();
+        this->descriptor = socket(AF_INET, SOCK_DGRAM, 0);
+        if (this->descriptor < 0) {
+            print("Unable to open socket");
+            return false;
+        }
+        int enable = 1;
+        setsockopt(this->descriptor, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons((this->role == MASTER) ? port : 0);
+        if (bind(this->descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            print("Unable to bind socket");
+            end();
+            return false;
+        }
+        fcntl(this->descriptor, F_SETFL, (fcntl(this->descriptor, F_GETFL) | O_NONBLOCK));
+        memset(&this->master, 0, sizeof(this->master));
+        this->master.sin_family = AF_INET;
+        this->master.sin_port = htons(port);
+        if (master != nullptr) {
+            inet_pton(AF_INET, master, &this->master.sin_addr);
+        } else {
+            this->master.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+        }
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+void ClockSync::end() {
+    #if ESP32
+        this->udp.stop();
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor >= 0) {
+            close(this->descriptor);
+        }
+        this->descriptor = -1;
+    #endif
+}
+
+bool ClockSync::run() {
+    /* Call often; arrival stamps are taken when run() notices a packet,
+    so polling latency adds to measured delay. Returns whether the
+    clock was corrected. */
+    bool corrected = false;
+    uint8_t packet[CLOCK_SYNC_SIZE * 2], reply[CLOCK_SYNC_SIZE];
+    #if ESP32
+        for (int size; (size = this->udp.parsePacket()) > 0;) {
+            uint64_t arrival = this->local();
+            size = this->udp.read(packet, sizeof(packet));
+            if (this->role == MASTER) {
+                if (respond(packet, size, reply, arrival)) {
+                    this->udp.beginPacket(this->udp.remoteIP(), this->udp.remotePort());
+                    this->udp.write(reply, CLOCK_SYNC_SIZE);
+                    this->udp.endPacket();
+                }
+            } else {
+                corrected |= receive(packet, size, arrival);
+            }
+        }
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor < 0) {
+            return false;
+        }
+        sockaddr_in sender;
+        socklen_t length = sizeof(sender);
+        for (ssize_t size; (size = recvfrom(this->descriptor, packet, sizeof(packet), 0, reinterpret_cast<sockaddr*>(&sender), &length)) > 0; length = sizeof(sender)) {
+            uint64_t arrival = this->local();
+            if (this->role == MASTER) {
+                if (respond(packet, size, reply, arrival)) {
+                    sendto(this->descriptor, reply, CLOCK_SYNC_SIZE, 0, reinterpret_cast<sockaddr*>(&sender), length);
+                }
+            } else {
+                corrected |= receive(packet, size, arrival);
+            }
+        }
+    #endif
+    if (this->role == FOLLOWER) {
+        uint64_t current = this->local();
+        if (!this->lastPoll || ((current - this->lastPoll) >= this->interval)) {
+            // A lost reply is simply superseded by the next request
+            this->lastPoll = current;
+            this->pending = current;
+            request(packet, current);
+            #if ESP32
+                this->udp.beginPacket(this->master, this->port);
+                this->udp.write(packet, CLOCK_SYNC_SIZE);
+                this->udp.endPacket();
+            #elif !defined(IS_EMBEDDED)
+                sendto(this->descriptor, packet, CLOCK_SYNC_SIZE, 0, reinterpret_cast<sockaddr*>(&this->master), sizeof(this->master));
+            #endif
+        }
+    }
+    return corrected;
+}
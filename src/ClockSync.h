@@ -0,0 +1,111 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include "SimpleSerialBase.h"
+
+#if ESP32
+    #include <WiFiUdp.h>
+#elif !defined(IS_EMBEDDED)
+    #include <netinet/in.h>
+#endif
+
+#define CLOCK_SYNC_PORT         6460
+#define CLOCK_SYNC_SIZE         32
+#define CLOCK_SYNC_INTERVAL     250000 // Microseconds between polls
+#define CLOCK_FILTER_SIZE       8 // Exchanges the offset filter chooses from
+#define CLOCK_DRIFT_SPAN        4000000 // Minimum microseconds between drift estimates
+#define CLOCK_STEP_THRESHOLD    50000 // Errors beyond this jump instead of slewing
+#define CLOCK_SLEW_TIME         2.0 // Seconds over which an error is slewed out
+#define CLOCK_MAX_SLEW          500e-6 // Largest rate correction from slewing
+
+class DisciplinedClock {
+    /* Maps a free-running local clock onto network time. Corrections
+    adjust the rate, so time never jumps for small errors and never
+    runs backward; drift between the two clocks is estimated from the
+    trend of successive offsets and folded into the rate. */
+    public:
+        uint64_t reference = 0; // Local time at the last correction
+        int64_t base = 0; // Network time at reference
+        int64_t lastOffset = 0;
+        uint64_t lastLocal = 0;
+        double rate = 1, drift = 0, slew = 0;
+        bool synchronized = false, driftKnown = false;
+        int64_t at(uint64_t local);
+        void discipline(uint64_t local, int64_t offset);
+        void reset();
+};
+
+class ClockSync : public SimpleSerialBase {
+    /* Lightweight two-way time transfer over UDP in the manner of NTP.
+    A follower stamps a request (t1), the master stamps its arrival and
+    the reply (t2, t3), and the follower stamps the reply's arrival
+    (t4). Of the last few exchanges, the one with the least round trip
+    delay gives the offset fed to the disciplined clock. */
+    public:
+        typedef uint64_t (*LocalClock)();
+        enum Role : uint8_t {MASTER, FOLLOWER};
+        struct Sample {
+            uint64_t local;
+            int64_t offset, delay;
+        };
+        DisciplinedClock clock;
+        LocalClock local;
+        std::array<Sample, CLOCK_FILTER_SIZE> samples;
+        uint32_t interval = CLOCK_SYNC_INTERVAL, exchanges = 0, rejected = 0;
+        uint64_t lastPoll = 0, pending = 0;
+        int64_t offset = 0, delay = 0;
+        uint16_t port = CLOCK_SYNC_PORT;
+        uint8_t role;
+        ClockSync(uint8_t role=FOLLOWER, LocalClock local=nullptr);
+        ~ClockSync();
+        bool begin(uint16_t port=CLOCK_SYNC_PORT, const char* master=nullptr);
+        void end();
+        bool run();
+        uint64_t now();
+        uint32_t now32();
+        bool synchronized();
+        size_t request(uint8_t* packet, uint64_t sent);
+        size_t respond(const uint8_t* packet, size_t size, uint8_t* reply, uint64_t arrival);
+        bool receive(const uint8_t* packet, size_t size, uint64_t arrival);
+        static uint64_t localMicros();
+    protected:
+        static void encode64(uint8_t*, uint64_t);
+        static uint64_t decode64(const uint8_t*);
+        void filter();
+        #if ESP32
+            WiFiUDP udp;
+            IPAddress master;
+        #elif !defined(IS_EMBEDDED)
+            int descriptor = -1;
+            sockaddr_in master;
+        #endif
+};
+
+#endif
@@ -28,9 +28,12 @@ ColorChannel::ColorChannel(
         uint8_t pin,
         uint8_t channel,
         uint8_t resolution,
-        double frequency
+        double frequency,
+        bool attach
     ) {
     this->pin = pin;
+    this->attached = attach;
+    this->muted = !attach;
     this->absoluteMaximum = (std::pow(2, resolution) - 1);
     this->maximum = this->absoluteMaximum;
     this->channel = channel;
@@ -39,12 +42,14 @@ ColorChannel::ColorChannel(
     this->frequency = (
             frequency <= 0 || (frequency > maxFrequency)
         ) ? maxFrequency : frequency;
-    #if ESP32 || ESP8266
-        ledcAttachPin(this->pin, this->channel);
-        ledcSetup(this->channel, this->frequency, this->resolution);
-    #elif __AVR__
-        pinMode(this->pin, OUTPUT);
-    #endif
+    if (this->attached) {
+        #if ESP32 || ESP8266
+            ledcAttachPin(this->pin, this->channel);
+            ledcSetup(this->channel, this->frequency, this->resolution);
+        #elif __AVR__
+            pinMode(this->pin, OUTPUT);
+        #endif
+    }
     set(this->maximum, true);
     this->target = this->value;
     save();
@@ -53,29 +58,55 @@ ColorChannel::ColorChannel(
 ColorChannel::~ColorChannel() {
     this->color = nullptr;
     #if ESP32 || ESP8266
-        ledcDetachPin(this->pin);
+        if (this->attached) {
+            ledcDetachPin(this->pin);
+        }
     #endif
 }
 
 void ColorChannel::write() {
+    if (!this->muted) {
+        output(this->value);
+    }
+}
+
+void ColorChannel::output(uint16_t val) {
+    // Writes a value to hardware without changing channel state
+    this->written = val;
+    if (this->deferred) {
+        return;
+    }
+    send(val);
+}
+
+void ColorChannel::send(uint16_t val) {
+    // Hardware write only; safe from an output task as it touches no state
+    if (!this->attached) {
+        return;
+    }
     #if ESP32 || ESP8266
         ledcWrite(this->channel, (
-                this->inverted ? getColorInversion() : this->value
+                this->inverted ? getColorInversion(val) : val
             ));
     #elif __AVR__
         analogWrite(this->channel, (
-                this->inverted ? getColorInversion() : this->value
+                this->inverted ? getColorInversion(val) : val
             ));
+    #else
+        (void) val;
     #endif
 }
 
 void ColorChannel::overwrite(uint16_t val) {
     this->value = val;
-    #if ESP32 || ESP8266
-        ledcWrite(this->channel, val);
-    #elif __AVR__
-        analogWrite(this->channel, val);
-    #endif
+    if (this->muted) {
+        return;
+    }
+    this->written = val;
+    if (this->deferred) {
+        return;
+    }
+    send(val);
 }
 
 uint16_t ColorChannel::conformAbsolute(uint16_t val) {
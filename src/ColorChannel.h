@@ -32,16 +32,26 @@
 
 class ColorChannel : public SimpleSerialBase {
     public:
-        bool verbose = false, inverted = false;
+        bool
+            verbose = false, inverted = false,
+            attached = true, // Whether bound to a hardware output
+            muted = false, // Suppresses hardware writes while composited
+            deferred = false; // Output is recorded but sent later by a RenderBuffer
         double frequency, steps, stepSize, scale = 1;
         uint8_t pin, channel, resolution;
         int16_t offset = 0;
         uint16_t value, target, last, absoluteMaximum, maximum, minimum = 0;
+        uint16_t written = 0; // Last value sent to the output
         uint16_t* color = &value;
         uint32_t delta, lastRounded;
-        ColorChannel(uint8_t pin, uint8_t channel, uint8_t resolution=8, double frequency=0);
+        ColorChannel(
+                uint8_t pin, uint8_t channel, uint8_t resolution=8,
+                double frequency=0, bool attach=true
+            );
         ~ColorChannel();
         void write();
+        void output(uint16_t val);
+        void send(uint16_t val);
         void overwrite(uint16_t val);
         uint16_t conformAbsolute(uint16_t);
         uint16_t conform(uint16_t);
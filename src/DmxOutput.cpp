@@ -0,0 +1,245 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "DmxOutput.h"
+
+#ifndef IS_EMBEDDED
+    #include <fcntl.h>
+    #include <stdlib.h>
+    #include <termios.h>
+    #include <unistd.h>
+    #include <chrono>
+#endif
+
+DmxOutput::DmxOutput(double rate) {
+    this->frame.fill(0);
+    setRate(rate);
+}
+
+DmxOutput::~DmxOutput() {
+    #if !defined(IS_EMBEDDED)
+        close();
+    #endif
+}
+
+void DmxOutput::setRate(double rate) {
+    this->interval = ((rate > 0) ? static_cast<uint32_t>(1e6 / rate) : (1000000 / DMX_REFRESH_RATE));
+}
+
+bool DmxOutput::patch(const uint16_t* source, uint16_t slot, uint8_t bits, bool fine) {
+    if (!slot || ((slot + (fine ? 1 : 0)) > DMX_SLOTS)) {
+        print("DMX slot out of range");
+        return false;
+    }
+    DmxPatch patch;
+    patch.source = source;
+    patch.slot = slot;
+    patch.bits = ((bits >= 1 && bits <= 16) ? bits : 8);
+    patch.fine = fine;
+    patch.last = *source;
+    this->patches.push_back(patch);
+    encode(this->patches.back());
+    return true;
+}
+
+template <unsigned int N>
+uint16_t DmxOutput::patch(LedWriter<N>* writer, uint16_t slot, bool fine) {
+    /* Patches the writer's channels to consecutive slots from slot,
+    following what each channel last output. Returns the next free
+    slot, or 0 if the writer did not fit. */
+    for (unsigned int i = 0; i < N; ++i) {
+        ColorChannel* channel = writer->channels[i];
+        if (!patch(&channel->written, slot, channel->resolution, fine)) {
+            return 0;
+        }
+        slot += (fine ? 2 : 1);
+    }
+    return slot;
+}
+
+uint16_t DmxOutput::patch(DynamicWriter* writer, uint16_t slot, bool fine) {
+    for (uint32_t i = 0; i < writer->width; ++i) {
+        if (!patch(&writer->values[i], slot, writer->resolution, fine)) {
+            return 0;
+        }
+        slot += (fine ? 2 : 1);
+    }
+    return slot;
+}
+
+void DmxOutput::unpatch() {
+    this->patches.clear();
+    std::fill((this->frame.begin() + 1), this->frame.end(), 0);
+}
+
+void DmxOutput::setStartCode(uint8_t code) {
+    // Zero for dimmer data; alternate codes mark other payloads
+    this->frame[0] = code;
+}
+
+void DmxOutput::encode(DmxPatch& patch) {
+    // Scales to 16 bits, then splits into coarse and fine slots
+    uint32_t scaled = std::min<uint32_t>(((static_cast<uint32_t>(patch.last) * 65535) / ((1 << patch.bits) - 1)), 65535);
+    this->frame[patch.slot] = (scaled >> 8);
+    if (patch.fine) {
+        this->frame[patch.slot + 1] = (scaled & 0xFF);
+    }
+}
+
+uint32_t DmxOutput::update() {
+    // Re-encodes only patches whose source moved; returns how many
+    uint32_t changed = 0;
+    for (auto& patch: this->patches) {
+        uint16_t value = *patch.source;
+        if (value != patch.last) {
+            patch.last = value;
+            encode(patch);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+bool DmxOutput::run() {
+    #ifdef IS_EMBEDDED
+        return run(micros());
+    #else
+        return run(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()));
+    #endif
+}
+
+bool DmxOutput::run(uint32_t currentTime) {
+    // Call every loop; sends a frame once per refresh interval
+    if (this->sending && ((currentTime - this->lastSent) < this->interval)) {
+        return false;
+    }
+    this->lastSent = currentTime;
+    this->sending = true;
+    update();
+    return send();
+}
+
+#if ESP32
+void DmxOutput::begin(HardwareSerial* uart, int8_t txPin) {
+    this->uart = uart;
+    this->uart->setTxBufferSize(DMX_FRAME_SIZE + 1);
+    this->uart->begin(DMX_BAUD, SERIAL_8N2, -1, txPin);
+}
+
+bool DmxOutput::send() {
+    if (this->uart == nullptr) {
+        return false;
+    }
+    // Break by sending a zero slowly, then the frame at line rate
+    this->uart->flush();
+    this->uart->updateBaudRate(DMX_BREAK_BAUD);
+    this->uart->write(static_cast<uint8_t>(0));
+    this->uart->flush();
+    this->uart->updateBaudRate(DMX_BAUD);
+    this->uart->write(this->frame.data(), DMX_FRAME_SIZE);
+    this->frames++;
+    return true;
+}
+#elif !defined(IS_EMBEDDED)
+bool DmxOutput::open(const char* path) {
+    /* Opens a serial adapter, pipe or file. Terminals are set raw; the
+    line rate is left to the adapter, as 250 kbaud has no termios code. */
+    close();
+    int opened = ::open(path, (O_WRONLY | O_NOCTTY));
+    if (opened < 0) {
+        print("Unable to open DMX output");
+        return false;
+    }
+    attach(opened);
+    this->owned = true;
+    return true;
+}
+
+const char* DmxOutput::openPty() {
+    // Stand-in for a UART; returns the path a reader should open
+    close();
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master < 0) || grantpt(master) || unlockpt(master)) {
+        if (master >= 0) {
+            ::close(master);
+        }
+        print("Unable to open pty");
+        return nullptr;
+    }
+    attach(master);
+    this->owned = true;
+    return ptsname(master);
+}
+
+void DmxOutput::attach(int descriptor) {
+    this->descriptor = descriptor;
+    this->owned = false;
+    if (isatty(descriptor)) {
+        struct termios settings;
+        if (!tcgetattr(descriptor, &settings)) {
+            cfmakeraw(&settings);
+            settings.c_cflag |= CSTOPB; // Two stop bits
+            tcsetattr(descriptor, TCSANOW, &settings);
+        }
+    }
+}
+
+void DmxOutput::close() {
+    if (this->owned && (this->descriptor >= 0)) {
+        ::close(this->descriptor);
+    }
+    this->descriptor = -1;
+    this->owned = false;
+}
+
+bool DmxOutput::send() {
+    if (this->descriptor < 0) {
+        return false;
+    }
+    if (isatty(this->descriptor)) {
+        tcdrain(this->descriptor);
+        tcsendbreak(this->descriptor, 0);
+    }
+    ssize_t sent = ::write(this->descriptor, this->frame.data(), DMX_FRAME_SIZE);
+    if (sent != DMX_FRAME_SIZE) {
+        this->dropped++;
+        return false;
+    }
+    this->frames++;
+    return true;
+}
+#else
+bool DmxOutput::send() {
+    // No UART transport on this target
+    return false;
+}
+#endif
+
+template uint16_t DmxOutput::patch<1>(LedWriter<1>*, uint16_t, bool);
+template uint16_t DmxOutput::patch<2>(LedWriter<2>*, uint16_t, bool);
+template uint16_t DmxOutput::patch<3>(LedWriter<3>*, uint16_t, bool);
+template uint16_t DmxOutput::patch<4>(LedWriter<4>*, uint16_t, bool);
+template uint16_t DmxOutput::patch<5>(LedWriter<5>*, uint16_t, bool);
@@ -0,0 +1,85 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef DMXOUTPUT_H
+#define DMXOUTPUT_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "LedWriter.h"
+#include "DynamicWriter.h"
+
+#define DMX_SLOTS               512
+#define DMX_FRAME_SIZE          513 // Start code plus slots
+#define DMX_REFRESH_RATE        40 // Frames per second; 44 is the ceiling at 512 slots
+#define DMX_BAUD                250000
+#define DMX_BREAK_BAUD          90000 // A zero byte at this rate spans break and mark-after-break
+
+struct DmxPatch {
+    const uint16_t* source;
+    uint16_t slot; // 1 - 512; fine patches also use the next slot
+    uint16_t last;
+    uint8_t bits; // Source resolution
+    bool fine; // 16-bit, coarse then fine
+};
+
+class DmxOutput : public SimpleSerialBase {
+    /* Keeps a DMX512 frame ready to send and mirrors patched values
+    into it. Only patches whose source changed are re-encoded, and the
+    frame goes out whole at the refresh rate, as DMX expects. */
+    public:
+        std::array<uint8_t, DMX_FRAME_SIZE> frame;
+        std::vector<DmxPatch> patches;
+        uint32_t interval, lastSent = 0, frames = 0, dropped = 0;
+        bool sending = false;
+        DmxOutput(double rate=DMX_REFRESH_RATE);
+        ~DmxOutput();
+        void setRate(double rate);
+        bool patch(const uint16_t* source, uint16_t slot, uint8_t bits=8, bool fine=false);
+        template <unsigned int N>
+        uint16_t patch(LedWriter<N>* writer, uint16_t slot, bool fine=false);
+        uint16_t patch(DynamicWriter* writer, uint16_t slot, bool fine=false);
+        void unpatch();
+        void setStartCode(uint8_t code);
+        uint32_t update();
+        bool run();
+        bool run(uint32_t currentTime);
+        bool send();
+        #if ESP32
+            HardwareSerial* uart = nullptr;
+            void begin(HardwareSerial* uart, int8_t txPin);
+        #elif !defined(IS_EMBEDDED)
+            int descriptor = -1;
+            bool owned = false;
+            bool open(const char* path);
+            const char* openPty();
+            void attach(int descriptor);
+            void close();
+        #endif
+    protected:
+        void encode(DmxPatch&);
+};
+
+#endif
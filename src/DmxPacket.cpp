@@ -0,0 +1,159 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "DmxPacket.h"
+#include <string.h>
+
+static const uint8_t artnetId[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+static const uint8_t acnId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+static uint16_t read16(const uint8_t* bytes) {
+    return ((bytes[0] << 8) | bytes[1]);
+}
+
+static void write16(uint8_t* bytes, uint16_t value) {
+    bytes[0] = (value >> 8);
+    bytes[1] = (value & 0xFF);
+}
+
+static void write32(uint8_t* bytes, uint32_t value) {
+    write16(bytes, (value >> 16));
+    write16((bytes + 2), (value & 0xFFFF));
+}
+
+bool DmxPacket::parse(uint8_t protocol, const uint8_t* packet, size_t size, DmxView& view) {
+    return ((protocol == E131) ? parseE131(packet, size, view) : parseArtDmx(packet, size, view));
+}
+
+bool DmxPacket::parseArtDmx(const uint8_t* packet, size_t size, DmxView& view) {
+    if (
+            (size < ARTNET_HEADER_SIZE)
+            || memcmp(packet, artnetId, sizeof(artnetId))
+            || ((packet[8] | (packet[9] << 8)) != ARTNET_OPCODE_DMX)
+            || (read16(packet + 10) < ARTNET_VERSION)
+        ) {
+        return false;
+    }
+    uint16_t length = read16(packet + 16);
+    if ((length < 2) || (length > 512) || ((ARTNET_HEADER_SIZE + length) > size)) {
+        return false;
+    }
+    view.slots = (packet + ARTNET_HEADER_SIZE);
+    view.length = length;
+    view.universe = ((packet[14] | (packet[15] << 8)) & 0x7FFF);
+    view.sequence = packet[12];
+    view.priority = E131_PRIORITY;
+    view.startCode = 0;
+    view.terminated = false;
+    return true;
+}
+
+bool DmxPacket::parseE131(const uint8_t* packet, size_t size, DmxView& view) {
+    if (
+            (size < E131_HEADER_SIZE)
+            || memcmp((packet + 4), acnId, sizeof(acnId))
+            || (read16(packet + 20) != 4) || (read16(packet + 18) != 0)
+            || (read16(packet + 42) != 2) || (read16(packet + 40) != 0)
+            || (packet[117] != 2)
+        ) {
+        return false;
+    }
+    uint16_t count = read16(packet + 123);
+    if (!count || (count > 513) || ((E131_HEADER_SIZE - 1 + count) > size)) {
+        return false;
+    }
+    view.slots = (packet + E131_HEADER_SIZE);
+    view.length = (count - 1);
+    view.universe = read16(packet + 113);
+    view.sequence = packet[111];
+    view.priority = packet[108];
+    view.startCode = packet[125];
+    view.terminated = (packet[112] & 0x40);
+    return true;
+}
+
+size_t DmxPacket::buildArtDmx(
+        uint8_t* packet, uint16_t universe, uint8_t sequence,
+        const uint8_t* slots, uint16_t length
+    ) {
+    // Length is rounded up to even as the protocol requires
+    length = ((length > 512) ? 512 : (length + (length & 1)));
+    memcpy(packet, artnetId, sizeof(artnetId));
+    packet[8] = (ARTNET_OPCODE_DMX & 0xFF);
+    packet[9] = (ARTNET_OPCODE_DMX >> 8);
+    write16((packet + 10), ARTNET_VERSION);
+    packet[12] = sequence;
+    packet[13] = 0;
+    packet[14] = (universe & 0xFF);
+    packet[15] = ((universe >> 8) & 0x7F);
+    write16((packet + 16), length);
+    if (slots != nullptr) {
+        memcpy((packet + ARTNET_HEADER_SIZE), slots, length);
+    }
+    return (ARTNET_HEADER_SIZE + length);
+}
+
+size_t DmxPacket::buildE131(
+        uint8_t* packet, uint16_t universe, uint8_t sequence,
+        const uint8_t* slots, uint16_t length,
+        const uint8_t* cid, const char* name, uint8_t priority
+    ) {
+    length = ((length > 512) ? 512 : length);
+    size_t total = (E131_HEADER_SIZE + length);
+    memset(packet, 0, E131_HEADER_SIZE);
+    // Root layer
+    write16(packet, 0x0010);
+    memcpy((packet + 4), acnId, sizeof(acnId));
+    write16((packet + 16), (0x7000 | (total - 16)));
+    write32((packet + 18), 4);
+    if (cid != nullptr) {
+        memcpy((packet + 22), cid, 16);
+    }
+    // Framing layer
+    write16((packet + 38), (0x7000 | (total - 38)));
+    write32((packet + 40), 2);
+    if (name != nullptr) {
+        strncpy(reinterpret_cast<char*>(packet + 44), name, 63);
+    }
+    packet[108] = priority;
+    packet[111] = sequence;
+    write16((packet + 113), universe);
+    // DMP layer
+    write16((packet + 115), (0x7000 | (total - 115)));
+    packet[117] = 2;
+    packet[118] = 0xA1;
+    write16((packet + 121), 1);
+    write16((packet + 123), (length + 1));
+    if (slots != nullptr) {
+        memcpy((packet + E131_HEADER_SIZE), slots, length);
+    }
+    return total;
+}
+
+bool DmxPacket::newer(uint8_t sequence, uint8_t last) {
+    /* E1.31 ordering: drop a packet up to 19 behind the last one seen;
+    anything further back is taken as the source restarting. */
+    int8_t difference = static_cast<int8_t>(sequence - last);
+    return ((difference > 0) || (difference <= -20));
+}
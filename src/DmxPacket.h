@@ -0,0 +1,91 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef DMXPACKET_H
+#define DMXPACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ARTNET_PORT             6454
+#define ARTNET_HEADER_SIZE      18
+#define ARTNET_OPCODE_DMX       0x5000
+#define ARTNET_VERSION          14
+#define E131_PORT               5568
+#define E131_HEADER_SIZE        126
+#define E131_PRIORITY           100
+#define DMX_PACKET_MAX          (E131_HEADER_SIZE + 512)
+
+/*
+    Network DMX layouts, multi-byte fields big-endian unless noted:
+
+    Art-Net ArtDmx
+        0   char[8]     "Art-Net\0"
+        8   uint16_t    OpCode 0x5000, little-endian
+        10  uint16_t    protocol version 14
+        12  uint8_t     sequence; 0 disables ordering
+        13  uint8_t     physical port
+        14  uint16_t    port-address, little-endian (net, sub-net, universe)
+        16  uint16_t    slot count, even, 2 - 512
+        18  uint8_t[]   slots from 1
+    E1.31 (sACN) data packet
+        0   root layer; ACN identifier "ASC-E1.17" at 4, vector 4 at 18
+        22  uint8_t[16] source CID
+        38  framing layer; vector 2 at 40, source name at 44
+        108 uint8_t     priority
+        111 uint8_t     sequence
+        112 uint8_t     options; bit 6 stream terminated
+        113 uint16_t    universe 1 - 63999
+        115 DMP layer; property count at 123 includes the start code
+        125 uint8_t     start code, then slots from 1
+*/
+
+struct DmxView {
+    // Points into the packet; valid as long as its buffer is
+    const uint8_t* slots;
+    uint16_t universe, length;
+    uint8_t sequence, priority, startCode;
+    bool terminated;
+};
+
+class DmxPacket {
+    public:
+        enum Protocol : uint8_t {ARTNET, E131};
+        static bool parse(uint8_t protocol, const uint8_t* packet, size_t size, DmxView& view);
+        static bool parseArtDmx(const uint8_t* packet, size_t size, DmxView& view);
+        static bool parseE131(const uint8_t* packet, size_t size, DmxView& view);
+        static size_t buildArtDmx(
+                uint8_t* packet, uint16_t universe, uint8_t sequence,
+                const uint8_t* slots, uint16_t length
+            );
+        static size_t buildE131(
+                uint8_t* packet, uint16_t universe, uint8_t sequence,
+                const uint8_t* slots, uint16_t length,
+                const uint8_t* cid=nullptr, const char* name=nullptr,
+                uint8_t priority=E131_PRIORITY
+            );
+        static bool newer(uint8_t sequence, uint8_t last);
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "DmxReceiver.h"
+
+#ifndef IS_EMBEDDED
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+DmxReceiver::DmxReceiver(uint8_t protocol) {
+    this->protocol = protocol;
+    this->universes.reserve(DMX_INPUT_UNIVERSES);
+}
+
+DmxReceiver::~DmxReceiver() {
+    end();
+}
+
+bool DmxReceiver::begin(uint16_t port) {
+    this->port = (port ? port : ((this->protocol == DmxPacket::E131) ? E131_PORT : ARTNET_PORT));
+    #if ESP32
+        return this->udp.begin(this->port);
+    #elif !defined(IS_EMBEDDED)
+        end();
+        this->descriptor = socket(AF_INET, SOCK_DGRAM, 0);
+        if (this->descriptor < 0) {
+            print("Unable to open socket");
+            return false;
+        }
+        int enable = 1;
+        setsockopt(this->descriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(this->port);
+        if (bind(this->descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            print("Unable to bind socket");
+            end();
+            return false;
+        }
+        fcntl(this->descriptor, F_SETFL, (fcntl(this->descriptor, F_GETFL) | O_NONBLOCK));
+        for (auto& universe: this->universes) {
+            join(universe.universe);
+        }
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+void DmxReceiver::end() {
+    #if ESP32
+        this->udp.stop();
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor >= 0) {
+            close(this->descriptor);
+        }
+        this->descriptor = -1;
+    #endif
+}
+
+#ifndef IS_EMBEDDED
+void DmxReceiver::join(uint16_t universe) {
+    // sACN universes arrive on 239.255.hi.lo; unicast needs no join
+    if ((this->protocol != DmxPacket::E131) || (this->descriptor < 0)) {
+        return;
+    }
+    ip_mreq membership = {};
+    membership.imr_multiaddr.s_addr = htonl(0xEFFF0000 | universe);
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    setsockopt(this->descriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+}
+#endif
+
+DmxUniverseState* DmxReceiver::state(uint16_t universe) {
+    for (auto& state: this->universes) {
+        if (state.universe == universe) {
+            return &state;
+        }
+    }
+    return nullptr;
+}
+
+bool DmxReceiver::addPatch(DmxInputPatch& patch) {
+    if (!patch.slot || ((patch.slot - 1 + (patch.width * (patch.fine ? 2 : 1))) > 512)) {
+        print("DMX slot range out of bounds");
+        return false;
+    }
+    if (state(patch.universe) == nullptr) {
+        DmxUniverseState added;
+        added.universe = patch.universe;
+        this->universes.push_back(added);
+        #ifndef IS_EMBEDDED
+            join(patch.universe);
+        #endif
+    }
+    this->patches.push_back(patch);
+    return true;
+}
+
+template <unsigned int N>
+bool DmxReceiver::patch(LedWriter<N>* writer, uint16_t universe, uint16_t slot, bool fine, double fade) {
+    /* Maps N (or 2N when fine) consecutive slots from slot onto the
+    writer. With a fade, each packet becomes a short fade toward the
+    new levels, smoothing consoles that update at low rates. The
+    receiver owns the writer's queue: packets replace or retarget
+    whatever is queued, so effects should not be queued alongside. */
+    DmxInputPatch patch;
+    patch.writer = writer;
+    patch.apply = applyWriter<N>;
+    patch.universe = universe;
+    patch.slot = slot;
+    patch.width = N;
+    patch.fade = Effect<N>::secondsToMicroseconds(fade);
+    patch.fine = fine;
+    return addPatch(patch);
+}
+
+bool DmxReceiver::patch(DynamicWriter* writer, uint16_t universe, uint16_t slot, bool fine, double fade) {
+    DmxInputPatch patch;
+    patch.writer = writer;
+    patch.apply = applyDynamic;
+    patch.universe = universe;
+    patch.slot = slot;
+    patch.width = writer->width;
+    patch.fade = static_cast<uint32_t>(fade * 1e6);
+    patch.fine = fine;
+    return addPatch(patch);
+}
+
+uint16_t DmxReceiver::decode(const uint8_t* slots, bool fine, uint8_t resolution) {
+    // Slot value(s) scaled to the writer's resolution
+    uint32_t value = (fine ? ((slots[0] << 8) | slots[1]) : ((slots[0] << 8) | slots[0]));
+    return (value >> (16 - resolution));
+}
+
+template <unsigned int N>
+void DmxReceiver::applyWriter(const DmxInputPatch& patch, const uint8_t* slots) {
+    LedWriter<N>* writer = static_cast<LedWriter<N>*>(patch.writer);
+    std::array<uint16_t, N> levels;
+    for (unsigned int i = 0; i < N; ++i, slots += (patch.fine ? 2 : 1)) {
+        levels[i] = decode(slots, patch.fine, writer->resolution);
+    }
+    if (!patch.fade) {
+        for (unsigned int i = 0; i < N; ++i) {
+            if (writer->channels[i]->value != levels[i]) {
+                writer->channels[i]->overwrite(levels[i]);
+            }
+        }
+        return;
+    }
+    if (writer->effectsQueued() && (writer->getTarget() == levels)) {
+        return;
+    }
+    Effect<N>* fade = writer->effect;
+    if ((writer->effectsQueued() == 1) && (fade != nullptr) && !fade->aborted) {
+        // Retarget the fade in flight; steady packet streams never allocate
+        fade->target = levels;
+        fade->setDuration(patch.fade * 1e-6);
+        if (fade->active) {
+            // Restarts from wherever the channels are now
+            fade->stepsRemaining = 0;
+            fade->activate();
+        }
+        writer->revision++;
+        return;
+    }
+    writer->clearEffects();
+    writer->createEffect(levels, (patch.fade * 1e-6));
+}
+
+void DmxReceiver::applyDynamic(const DmxInputPatch& patch, const uint8_t* slots) {
+    DynamicWriter* writer = static_cast<DynamicWriter*>(patch.writer);
+    uint16_t levels[512];
+    for (uint32_t i = 0; i < patch.width; ++i, slots += (patch.fine ? 2 : 1)) {
+        levels[i] = decode(slots, patch.fine, writer->resolution);
+    }
+    if (!patch.fade) {
+        writer->clearEffects();
+        writer->set(levels);
+        return;
+    }
+    // Queue slots are preallocated, so replacing the fade costs no allocation
+    writer->clearEffects();
+    writer->createEffect(levels, (patch.fade * 1e-6));
+}
+
+bool DmxReceiver::handle(const uint8_t* packet, size_t size) {
+    // Parses in place and applies every patch on the packet's universe
+    DmxView view;
+    if (!DmxPacket::parse(this->protocol, packet, size, view) || view.startCode) {
+        this->rejected++;
+        return false;
+    }
+    DmxUniverseState* universe = state(view.universe);
+    if (universe == nullptr) {
+        return false;
+    }
+    // Art-Net sequence 0 disables ordering; in E1.31 it is just the value after 255
+    bool ordered = (view.sequence || (this->protocol != DmxPacket::ARTNET));
+    if (universe->seen && ordered && !DmxPacket::newer(view.sequence, universe->sequence)) {
+        universe->dropped++;
+        return false;
+    }
+    universe->seen = true;
+    universe->sequence = view.sequence;
+    universe->packets++;
+    this->packets++;
+    if (view.terminated) {
+        return true;
+    }
+    for (const auto& patch: this->patches) {
+        if (patch.universe != view.universe) {
+            continue;
+        }
+        uint32_t end = (patch.slot - 1 + (patch.width * (patch.fine ? 2 : 1)));
+        if (end <= view.length) {
+            patch.apply(patch, (view.slots + patch.slot - 1));
+        }
+    }
+    return true;
+}
+
+uint32_t DmxReceiver::run() {
+    // Drains every waiting packet; returns how many were applied
+    uint32_t handled = 0;
+    #if ESP32
+        for (int size; (size = this->udp.parsePacket()) > 0;) {
+            size = this->udp.read(this->buffer.data(), this->buffer.size());
+            handled += handle(this->buffer.data(), size);
+        }
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor < 0) {
+            return 0;
+        }
+        for (ssize_t size; (size = recv(this->descriptor, this->buffer.data(), this->buffer.size(), 0)) > 0;) {
+            handled += handle(this->buffer.data(), size);
+        }
+    #endif
+    return handled;
+}
+
+template bool DmxReceiver::patch<1>(LedWriter<1>*, uint16_t, uint16_t, bool, double);
+template bool DmxReceiver::patch<2>(LedWriter<2>*, uint16_t, uint16_t, bool, double);
+template bool DmxReceiver::patch<3>(LedWriter<3>*, uint16_t, uint16_t, bool, double);
+template bool DmxReceiver::patch<4>(LedWriter<4>*, uint16_t, uint16_t, bool, double);
+template bool DmxReceiver::patch<5>(LedWriter<5>*, uint16_t, uint16_t, bool, double);
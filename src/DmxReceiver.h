@@ -0,0 +1,94 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef DMXRECEIVER_H
+#define DMXRECEIVER_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "DmxPacket.h"
+#include "LedWriter.h"
+#include "DynamicWriter.h"
+
+#if ESP32
+    #include <WiFiUdp.h>
+#endif
+
+#define DMX_INPUT_UNIVERSES     16
+
+struct DmxInputPatch {
+    /* Slot range feeding one writer. apply is the width-specific
+    writer update, so patches of any channel count share one list. */
+    void* writer;
+    void (*apply)(const DmxInputPatch&, const uint8_t* slots);
+    uint16_t universe, slot; // Slot from 1
+    uint16_t width; // Channels
+    uint32_t fade; // Microseconds; 0 overwrites immediately
+    bool fine;
+};
+
+struct DmxUniverseState {
+    uint16_t universe;
+    uint8_t sequence;
+    bool seen = false;
+    uint32_t packets = 0, dropped = 0;
+};
+
+class DmxReceiver : public SimpleSerialBase {
+    /* Receives Art-Net ArtDmx or E1.31 packets into one fixed buffer,
+    parses them where they lie and hands slot ranges to patched writers.
+    Out-of-order packets are dropped per universe by sequence number. */
+    public:
+        std::array<uint8_t, DMX_PACKET_MAX> buffer;
+        std::vector<DmxInputPatch> patches;
+        std::vector<DmxUniverseState> universes;
+        uint32_t packets = 0, rejected = 0;
+        uint16_t port = 0;
+        uint8_t protocol;
+        DmxReceiver(uint8_t protocol=DmxPacket::ARTNET);
+        ~DmxReceiver();
+        bool begin(uint16_t port=0);
+        void end();
+        template <unsigned int N>
+        bool patch(LedWriter<N>* writer, uint16_t universe, uint16_t slot, bool fine=false, double fade=0);
+        bool patch(DynamicWriter* writer, uint16_t universe, uint16_t slot, bool fine=false, double fade=0);
+        uint32_t run();
+        bool handle(const uint8_t* packet, size_t size);
+        DmxUniverseState* state(uint16_t universe);
+    protected:
+        bool addPatch(DmxInputPatch&);
+        static uint16_t decode(const uint8_t* slots, bool fine, uint8_t resolution);
+        template <unsigned int N>
+        static void applyWriter(const DmxInputPatch&, const uint8_t* slots);
+        static void applyDynamic(const DmxInputPatch&, const uint8_t* slots);
+        #if ESP32
+            WiFiUDP udp;
+        #elif !defined(IS_EMBEDDED)
+            int descriptor = -1;
+            void join(uint16_t universe);
+        #endif
+};
+
+#endif
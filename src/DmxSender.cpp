@@ -0,0 +1,227 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "DmxSender.h"
+#include "Random.h"
+#include <string.h>
+
+#ifndef IS_EMBEDDED
+    #include <arpa/inet.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #include <chrono>
+#endif
+
+DmxSender::DmxSender(uint8_t protocol, double rate, double keepAlive) {
+    this->protocol = protocol;
+    this->interval = ((rate > 0) ? static_cast<uint32_t>(1e6 / rate) : (1000000 / DMX_NETWORK_RATE));
+    this->keepAlive = static_cast<uint32_t>(keepAlive * 1e6);
+    // Source identifier for E1.31; only needs to be unique per run
+    Random generator;
+    #ifdef IS_EMBEDDED
+        generator.seed(micros());
+    #else
+        generator.seed(std::chrono::steady_clock::now().time_since_epoch().count());
+    #endif
+    for (int i = 0; i < 16; i += 4) {
+        uint32_t random = generator.next();
+        memcpy((this->cid + i), &random, 4);
+    }
+}
+
+DmxSender::~DmxSender() {
+    end();
+    for (auto universe: this->universes) {
+        delete universe;
+    }
+    this->universes.clear();
+}
+
+DmxOutput* DmxSender::addUniverse(uint16_t universe, const char* address, uint16_t port) {
+    /* Returns the universe's frame for patching. Without an address,
+    E1.31 goes to the universe's multicast group and Art-Net is
+    broadcast. */
+    DmxNetworkUniverse* added = new DmxNetworkUniverse;
+    added->universe = universe;
+    added->output.setRate(0);
+    bool multicast = (this->protocol == DmxPacket::E131);
+    port = (port ? port : (multicast ? E131_PORT : ARTNET_PORT));
+    #if ESP32
+        if (address != nullptr) {
+            added->address.fromString(address);
+        } else {
+            added->address = (
+                    multicast
+                    ? IPAddress(239, 255, (universe >> 8), (universe & 0xFF))
+                    : IPAddress(255, 255, 255, 255)
+                );
+        }
+        added->port = port;
+    #elif !defined(IS_EMBEDDED)
+        memset(&added->destination, 0, sizeof(added->destination));
+        added->destination.sin_family = AF_INET;
+        added->destination.sin_port = htons(port);
+        if (address != nullptr) {
+            inet_pton(AF_INET, address, &added->destination.sin_addr);
+        } else {
+            added->destination.sin_addr.s_addr = htonl(multicast ? (0xEFFF0000 | universe) : INADDR_BROADCAST);
+        }
+    #endif
+    // Header once; only the sequence and slots change per packet
+    if (multicast) {
+        added->size = DmxPacket::buildE131(added->packet.data(), universe, 0, nullptr, DMX_SLOTS, this->cid, "LedWriter");
+    } else {
+        added->size = DmxPacket::buildArtDmx(added->packet.data(), universe, 0, nullptr, DMX_SLOTS);
+    }
+    this->universes.push_back(added);
+    this->due.resize(this->universes.size());
+    #if !defined(IS_EMBEDDED) && __linux__
+        this->messages.resize(this->universes.size());
+        this->vectors.resize(this->universes.size());
+    #endif
+    return &added->output;
+}
+
+bool DmxSender::begin() {
+    #if ESP32
+        return this->udp.begin(0);
+    #elif !defined(IS_EMBEDDED)
+        end();
+        this->descriptor = socket(AF_INET, SOCK_DGRAM, 0);
+        if (this->descriptor < 0) {
+            print("Unable to open socket");
+            return false;
+        }
+        int enable = 1;
+        setsockopt(this->descriptor, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+void DmxSender::end() {
+    #if ESP32
+        this->udp.stop();
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor >= 0) {
+            close(this->descriptor);
+        }
+        this->descriptor = -1;
+    #endif
+}
+
+void DmxSender::prepare(DmxNetworkUniverse* universe) {
+    // Next sequence and current slots into the prebuilt packet
+    universe->sequence++;
+    if ((this->protocol == DmxPacket::ARTNET) && !universe->sequence) {
+        universe->sequence = 1; // Zero would disable ordering
+    }
+    if (this->protocol == DmxPacket::E131) {
+        universe->packet[111] = universe->sequence;
+        memcpy((universe->packet.data() + E131_HEADER_SIZE), (universe->output.frame.data() + 1), DMX_SLOTS);
+    } else {
+        universe->packet[12] = universe->sequence;
+        memcpy((universe->packet.data() + ARTNET_HEADER_SIZE), (universe->output.frame.data() + 1), DMX_SLOTS);
+    }
+}
+
+uint32_t DmxSender::flush(uint32_t count) {
+    // Sends the first count due packets; returns how many left
+    uint32_t sent = 0;
+    #if ESP32
+        for (uint32_t i = 0; i < count; ++i) {
+            DmxNetworkUniverse* universe = this->due[i];
+            this->udp.beginPacket(universe->address, universe->port);
+            this->udp.write(universe->packet.data(), universe->size);
+            sent += this->udp.endPacket();
+        }
+    #elif !defined(IS_EMBEDDED) && __linux__
+        for (uint32_t i = 0; i < count; ++i) {
+            DmxNetworkUniverse* universe = this->due[i];
+            this->vectors[i].iov_base = universe->packet.data();
+            this->vectors[i].iov_len = universe->size;
+            memset(&this->messages[i], 0, sizeof(mmsghdr));
+            this->messages[i].msg_hdr.msg_name = &universe->destination;
+            this->messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            this->messages[i].msg_hdr.msg_iov = &this->vectors[i];
+            this->messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        while (sent < count) {
+            int batch = sendmmsg(this->descriptor, (this->messages.data() + sent), (count - sent), 0);
+            if (batch <= 0) {
+                break;
+            }
+            sent += batch;
+        }
+    #elif !defined(IS_EMBEDDED)
+        for (uint32_t i = 0; i < count; ++i) {
+            DmxNetworkUniverse* universe = this->due[i];
+            ssize_t result = sendto(
+                    this->descriptor, universe->packet.data(), universe->size, 0,
+                    reinterpret_cast<sockaddr*>(&universe->destination), sizeof(sockaddr_in)
+                );
+            sent += (result == static_cast<ssize_t>(universe->size));
+        }
+    #endif
+    this->failed += (count - sent);
+    return sent;
+}
+
+uint32_t DmxSender::run() {
+    #ifdef IS_EMBEDDED
+        return run(micros());
+    #else
+        return run(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()));
+    #endif
+}
+
+uint32_t DmxSender::run(uint32_t currentTime) {
+    /* Call every loop. A universe is sent when its interval has passed
+    and its slots changed, or when it is due for a keep-alive. */
+    uint32_t count = 0;
+    for (auto universe: this->universes) {
+        uint32_t elapsed = (currentTime - universe->lastSent);
+        if (universe->sent && (elapsed < this->interval)) {
+            continue;
+        }
+        bool changed = (universe->output.update() > 0);
+        if (universe->sent && !changed && (elapsed < this->keepAlive)) {
+            this->skipped++;
+            continue;
+        }
+        prepare(universe);
+        universe->lastSent = currentTime;
+        universe->sent = true;
+        this->due[count++] = universe;
+    }
+    if (!count) {
+        return 0;
+    }
+    uint32_t sent = flush(count);
+    this->packets += sent;
+    return sent;
+}
@@ -0,0 +1,94 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef DMXSENDER_H
+#define DMXSENDER_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "DmxPacket.h"
+#include "DmxOutput.h"
+
+#if ESP32
+    #include <WiFiUdp.h>
+#elif !defined(IS_EMBEDDED)
+    #include <netinet/in.h>
+    #if __linux__
+        #include <sys/socket.h>
+    #endif
+#endif
+
+#define DMX_NETWORK_RATE        44 // Packets per second per universe, at most
+#define DMX_KEEPALIVE           1 // Seconds between repeats of unchanged data
+
+struct DmxNetworkUniverse {
+    DmxOutput output; // Patches and the current frame
+    std::array<uint8_t, DMX_PACKET_MAX> packet; // Header built once
+    size_t size;
+    uint16_t universe;
+    uint8_t sequence = 0;
+    uint32_t lastSent = 0;
+    bool sent = false;
+    #if ESP32
+        IPAddress address;
+        uint16_t port;
+    #elif !defined(IS_EMBEDDED)
+        sockaddr_in destination;
+    #endif
+};
+
+class DmxSender : public SimpleSerialBase {
+    /* Publishes patched channel state as Art-Net or E1.31. Each universe
+    keeps a prebuilt packet; a universe goes out at most at the network
+    rate, only when its slots changed, or as a keep-alive. Due packets
+    leave in one sendmmsg() call per run on Linux. */
+    public:
+        std::vector<DmxNetworkUniverse*> universes;
+        uint32_t interval, keepAlive, packets = 0, skipped = 0, failed = 0;
+        uint8_t protocol;
+        uint8_t cid[16];
+        DmxSender(uint8_t protocol=DmxPacket::E131, double rate=DMX_NETWORK_RATE, double keepAlive=DMX_KEEPALIVE);
+        ~DmxSender();
+        DmxOutput* addUniverse(uint16_t universe, const char* address=nullptr, uint16_t port=0);
+        bool begin();
+        void end();
+        uint32_t run();
+        uint32_t run(uint32_t currentTime);
+    protected:
+        void prepare(DmxNetworkUniverse*);
+        uint32_t flush(uint32_t count);
+        std::vector<DmxNetworkUniverse*> due;
+        #if ESP32
+            WiFiUDP udp;
+        #elif !defined(IS_EMBEDDED)
+            int descriptor = -1;
+            #if __linux__
+                std::vector<mmsghdr> messages;
+                std::vector<iovec> vectors;
+            #endif
+        #endif
+};
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "DynamicWriter.h"
+
+DynamicWriter::DynamicWriter(
+        uint32_t width, uint32_t capacity, uint8_t resolution,
+        std::vector<uint8_t> pins
+    ) {
+    this->width = width;
+    this->capacity = (capacity ? capacity : 1);
+    this->resolution = (resolution >= 1 && resolution <= 15 ? resolution : 8);
+    this->maximum = ((1 << this->resolution) - 1);
+    this->values.assign(width, 0);
+    // Target and origin for every slot, back to back
+    this->block.assign(static_cast<size_t>(this->capacity) * width * 2, 0);
+    this->slots.resize(this->capacity);
+    for (uint32_t i = 0; i < this->capacity; ++i) {
+        this->slots[i].target = &this->block[static_cast<size_t>(i) * width * 2];
+        this->slots[i].origin = (this->slots[i].target + width);
+    }
+    // Pins map to the leading channels; the rest are values only
+    for (uint32_t i = 0; (i < pins.size()) && (i < width); ++i) {
+        this->channels.push_back(new ColorChannel(pins[i], i, this->resolution));
+        this->channels.back()->overwrite(0);
+    }
+    #ifdef IS_EMBEDDED
+        this->timeIndex = micros();
+    #endif
+}
+
+DynamicWriter::~DynamicWriter() {
+    for (auto channel: this->channels) {
+        delete channel;
+    }
+    this->channels.clear();
+}
+
+void DynamicWriter::set(const uint16_t* color) {
+    // Immediate; does not disturb queued effects
+    for (uint32_t i = 0; i < this->width; ++i) {
+        this->values[i] = std::min(color[i], this->maximum);
+    }
+    write();
+}
+
+DynamicEffect* DynamicWriter::createEffect(
+        const uint16_t* target, double duration, double relativeStart,
+        uint32_t effectUID, int32_t loop, const Easing* easing
+    ) {
+    return createEffectAbsolute(
+            target, static_cast<uint32_t>(duration * 1e6),
+            (this->now + static_cast<uint32_t>(relativeStart * 1e6)),
+            effectUID, loop, easing
+        );
+}
+
+DynamicEffect* DynamicWriter::createEffectAbsolute(
+        const uint16_t* target, uint32_t duration, uint32_t absoluteStart,
+        uint32_t effectUID, int32_t loop, const Easing* easing
+    ) {
+    if (this->count >= this->capacity) {
+        print("Effect queue full");
+        return nullptr;
+    }
+    DynamicEffect* effect = &this->slots[(this->head + this->count) % this->capacity];
+    this->count++;
+    effect->start = absoluteStart;
+    effect->duration = duration;
+    effect->position = 0;
+    effect->uid = effectUID;
+    effect->loop = loop;
+    effect->easing = (easing != nullptr ? easing : Easing::get(Easing::LINEAR));
+    effect->active = false;
+    for (uint32_t i = 0; i < this->width; ++i) {
+        effect->target[i] = std::min(target[i], this->maximum);
+    }
+    return effect;
+}
+
+uint32_t DynamicWriter::effectsQueued() {
+    return this->count;
+}
+
+void DynamicWriter::clearEffects() {
+    this->head = 0;
+    this->count = 0;
+}
+
+DynamicEffect* DynamicWriter::front() {
+    return (this->count ? &this->slots[this->head] : nullptr);
+}
+
+void DynamicWriter::pop() {
+    this->head = ((this->head + 1) % this->capacity);
+    this->count--;
+}
+
+void DynamicWriter::write() {
+    for (uint32_t i = 0; i < this->channels.size(); ++i) {
+        this->channels[i]->overwrite(this->values[i]);
+    }
+}
+
+bool DynamicWriter::step(DynamicEffect* effect) {
+    // Interpolates every channel for now; returns whether finished
+    if (!effect->active) {
+        // Timed from activation, as a late effect still plays in full
+        std::copy(this->values.begin(), this->values.end(), effect->origin);
+        effect->start = this->now;
+        effect->active = true;
+    }
+    effect->position = (this->now - effect->start);
+    uint16_t progress = Easing::progress(effect->position, effect->duration);
+    // Scaled to 0 - 65536 so the final step lands exactly on target
+    int64_t eased = ((progress == 65535) ? 65536 : effect->easing->evaluate(progress));
+    const uint16_t* origin = effect->origin;
+    const uint16_t* target = effect->target;
+    uint16_t* values = this->values.data();
+    for (uint32_t i = 0; i < this->width; ++i) {
+        values[i] = (origin[i] + (((static_cast<int32_t>(target[i]) - origin[i]) * eased) >> 16));
+    }
+    return (progress == 65535);
+}
+
+void DynamicWriter::run() {
+    #ifdef IS_EMBEDDED
+        uint32_t sampled = micros();
+        this->now += (sampled - this->timeIndex);
+        this->timeIndex = sampled;
+    #endif
+    run(this->now);
+}
+
+void DynamicWriter::run(uint32_t currentTime) {
+    this->now = currentTime;
+    DynamicEffect* effect = front();
+    if ((effect == nullptr) || (static_cast<int32_t>(this->now - effect->start) < 0)) {
+        return;
+    }
+    bool finished = step(effect);
+    write();
+    if (!finished) {
+        return;
+    }
+    pop();
+    if (effect->loop != 0) {
+        /* Requeue at the back; a slot was just freed, so this cannot
+        fail even with the queue full. */
+        if (effect->loop > 0) {
+            effect->loop--;
+        }
+        createEffectAbsolute(
+                effect->target, effect->duration, this->now,
+                effect->uid, effect->loop, effect->easing
+            );
+    }
+}
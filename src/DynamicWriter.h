@@ -0,0 +1,82 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef DYNAMICWRITER_H
+#define DYNAMICWRITER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ColorChannel.h"
+#include "Easing.h"
+
+struct DynamicEffect {
+    uint32_t start, duration, position, uid;
+    int32_t loop;
+    const Easing* easing;
+    uint16_t* target; // width values in the writer's block
+    uint16_t* origin; // Captured on activation
+    bool active;
+};
+
+class DynamicWriter : public SimpleSerialBase {
+    /* Runtime-width counterpart to LedWriter for fixtures with more
+    emitters than the fixed instantiations cover. Queue slots and their
+    target and origin values live in one block sized at construction,
+    so queueing and stepping never allocate. Fades are closed-form,
+    linear unless given an easing. */
+    public:
+        std::vector<uint16_t> values; // Current output, one per channel
+        std::vector<ColorChannel*> channels; // Hardware outputs, if any
+        std::vector<DynamicEffect> slots;
+        std::vector<uint16_t> block;
+        uint32_t width, capacity, head = 0, count = 0;
+        uint32_t now = 0, timeIndex = 0;
+        uint16_t maximum;
+        uint8_t resolution;
+        DynamicWriter(
+                uint32_t width, uint32_t capacity=64, uint8_t resolution=10,
+                std::vector<uint8_t> pins={}
+            );
+        ~DynamicWriter();
+        void set(const uint16_t* color);
+        DynamicEffect* createEffect(
+                const uint16_t* target, double duration=1, double relativeStart=0,
+                uint32_t effectUID=0, int32_t loop=0, const Easing* easing=nullptr
+            );
+        DynamicEffect* createEffectAbsolute(
+                const uint16_t* target, uint32_t duration, uint32_t absoluteStart,
+                uint32_t effectUID=0, int32_t loop=0, const Easing* easing=nullptr
+            );
+        uint32_t effectsQueued();
+        void clearEffects();
+        void write();
+        void run();
+        void run(uint32_t currentTime);
+    protected:
+        DynamicEffect* front();
+        void pop();
+        bool step(DynamicEffect*);
+};
+
+#endif
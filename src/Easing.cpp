@@ -0,0 +1,145 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Easing.h"
+#include <cmath>
+
+Easing::Easing(Curve curve) {
+    // Tables are computed once; per-tick evaluation is a lookup and a lerp
+    this->curve = curve;
+    for (int i = 0; i < EASING_TABLE_SIZE; ++i) {
+        double y = shape(curve, static_cast<double>(i) / (EASING_TABLE_SIZE - 1));
+        y = (y <= 1 ? y : 1); // Maximum 1
+        y = (y >= 0 ? y : 0); // Minimum 0
+        this->table[i] = std::lround(y * 65535);
+    }
+}
+
+Easing::Easing(double x1, double y1, double x2, double y2) {
+    // Custom cubic Bezier from (0, 0) to (1, 1) with control points (x1, y1), (x2, y2)
+    this->curve = BEZIER;
+    x1 = (x1 <= 1 ? (x1 >= 0 ? x1 : 0) : 1);
+    x2 = (x2 <= 1 ? (x2 >= 0 ? x2 : 0) : 1);
+    for (int i = 0; i < EASING_TABLE_SIZE; ++i) {
+        double x = static_cast<double>(i) / (EASING_TABLE_SIZE - 1);
+        double y = bezier(solveBezier(x, x1, x2), y1, y2);
+        y = (y <= 1 ? y : 1); // Maximum 1
+        y = (y >= 0 ? y : 0); // Minimum 0
+        this->table[i] = std::lround(y * 65535);
+    }
+}
+
+const Easing* Easing::get(Curve curve) {
+    // Shared tables for built-in curves; built on first use only
+    switch (curve) {
+        case EASE_IN: { static const Easing easing(EASE_IN); return &easing; }
+        case EASE_OUT: { static const Easing easing(EASE_OUT); return &easing; }
+        case EASE_IN_OUT: { static const Easing easing(EASE_IN_OUT); return &easing; }
+        case CUBIC_IN: { static const Easing easing(CUBIC_IN); return &easing; }
+        case CUBIC_OUT: { static const Easing easing(CUBIC_OUT); return &easing; }
+        case CUBIC_IN_OUT: { static const Easing easing(CUBIC_IN_OUT); return &easing; }
+        case EXPONENTIAL_IN: { static const Easing easing(EXPONENTIAL_IN); return &easing; }
+        case EXPONENTIAL_OUT: { static const Easing easing(EXPONENTIAL_OUT); return &easing; }
+        case EXPONENTIAL_IN_OUT: { static const Easing easing(EXPONENTIAL_IN_OUT); return &easing; }
+        default: { static const Easing easing(LINEAR); return &easing; }
+    }
+}
+
+uint16_t Easing::progress(uint32_t position, uint32_t duration) {
+    // Fraction of duration elapsed, scaled to 0 - 65535
+    if (!duration || (position >= duration)) {
+        return 65535;
+    }
+    return ((static_cast<uint64_t>(position) * 65535) / duration);
+}
+
+uint16_t Easing::evaluate(uint16_t progress) const {
+    uint16_t index = (progress >> (16 - EASING_TABLE_BITS));
+    int32_t fraction = (progress & ((1 << (16 - EASING_TABLE_BITS)) - 1));
+    int32_t first = this->table[index], second = this->table[index + 1];
+    return (first + (((second - first) * fraction) >> (16 - EASING_TABLE_BITS)));
+}
+
+int32_t Easing::interpolate(int32_t from, int32_t to, uint16_t progress) const {
+    if (progress == 65535) {
+        return to;
+    }
+    return (from + (((to - from) * static_cast<int64_t>(evaluate(progress))) / 65535));
+}
+
+double Easing::shape(Curve curve, double x) {
+    switch (curve) {
+        case EASE_IN:
+            return (x * x);
+        case EASE_OUT:
+            return (1 - ((1 - x) * (1 - x)));
+        case EASE_IN_OUT:
+            return (x < .5 ? (2 * x * x) : (1 - (std::pow(2 - (2 * x), 2) / 2)));
+        case CUBIC_IN:
+            return (x * x * x);
+        case CUBIC_OUT:
+            return (1 - std::pow(1 - x, 3));
+        case CUBIC_IN_OUT:
+            return (x < .5 ? (4 * x * x * x) : (1 - (std::pow(2 - (2 * x), 3) / 2)));
+        case EXPONENTIAL_IN:
+            return (x <= 0 ? 0 : std::pow(2, (10 * x) - 10));
+        case EXPONENTIAL_OUT:
+            return (x >= 1 ? 1 : (1 - std::pow(2, -10 * x)));
+        case EXPONENTIAL_IN_OUT:
+            if (x <= 0 || x >= 1) {
+                return x;
+            }
+            return (
+                    x < .5
+                    ? (std::pow(2, (20 * x) - 10) / 2)
+                    : ((2 - std::pow(2, (-20 * x) + 10)) / 2)
+                );
+        default:
+            return x;
+    }
+}
+
+double Easing::bezier(double t, double first, double second) {
+    // One axis of a cubic Bezier anchored at 0 and 1
+    double inverse = (1 - t);
+    return (
+            (3 * inverse * inverse * t * first)
+            + (3 * inverse * t * t * second)
+            + (t * t * t)
+        );
+}
+
+double Easing::solveBezier(double x, double x1, double x2) {
+    // Bisect for the curve parameter at x; monotonic with x1, x2 within 0 - 1
+    double low = 0, high = 1, t = x;
+    for (int i = 0; i < 32; ++i) {
+        t = ((low + high) / 2);
+        if (bezier(t, x1, x2) < x) {
+            low = t;
+        } else {
+            high = t;
+        }
+    }
+    return t;
+}
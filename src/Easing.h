@@ -0,0 +1,64 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef EASING_H
+#define EASING_H
+
+#include <array>
+#include <stdint.h>
+
+#define EASING_TABLE_BITS       8
+#define EASING_TABLE_SIZE       ((1 << EASING_TABLE_BITS) + 1)
+
+class Easing {
+    public:
+        enum Curve : uint8_t {
+            LINEAR,
+            EASE_IN,
+            EASE_OUT,
+            EASE_IN_OUT,
+            CUBIC_IN,
+            CUBIC_OUT,
+            CUBIC_IN_OUT,
+            EXPONENTIAL_IN,
+            EXPONENTIAL_OUT,
+            EXPONENTIAL_IN_OUT,
+            BEZIER
+        };
+        Curve curve;
+        // Eased output (0 - 65535) sampled at evenly spaced progress points
+        std::array<uint16_t, EASING_TABLE_SIZE> table;
+        Easing(Curve curve=LINEAR);
+        Easing(double x1, double y1, double x2, double y2);
+        static const Easing* get(Curve);
+        static uint16_t progress(uint32_t position, uint32_t duration);
+        uint16_t evaluate(uint16_t progress) const;
+        int32_t interpolate(int32_t from, int32_t to, uint16_t progress) const;
+    protected:
+        static double shape(Curve, double);
+        static double bezier(double, double, double);
+        static double solveBezier(double, double, double);
+};
+
+#endif
@@ -73,7 +73,7 @@ void Hold::status() {
         }
 }
 
-bool Hold::step(uint32_t stepsRemaining) {
+bool Hold::step(uint32_t stepsRemaining, uint32_t now) {
     // Return true if hold is active
     if (!this->active && (stepsRemaining <= this->threshold)) {
         this->active = true;
@@ -83,11 +83,10 @@ bool Hold::step(uint32_t stepsRemaining) {
                     this->threshold, stepsRemaining, this->remaining * 1e-6
                 );
         }
-        this->last = micros();
+        this->last = now;
     }
     if (this->active) {
         // Subtract elapsed microseconds from remaining hold time
-        uint32_t now = micros();
         this->remaining -= (now - this->last);
         this->last = now;
         if (this->remaining <= 0){
@@ -110,10 +109,14 @@ Effect<N>::Effect(
         double startVariation,
         double durationVariation,
         uint32_t uid,
-        int32_t loop
+        int32_t loop,
+        const Easing* easing,
+        Random* random
     ) {
     this->channels = channels;
     this->recall = recall;
+    this->easing = easing;
+    this->random = random;
     for (int i = 0; i < N; ++i) {
         this->current[i] = (*this->channels)[i]->color;
         this->target[i] = (*this->channels)[i]->conform(target[i]);
@@ -128,16 +131,18 @@ Effect<N>::Effect(
     this->end = (this->start + this->duration);
     this->uid = uid;
     this->loop = loop;
-    varyStart(startVariation);
-    varyDuration(durationVariation);
+    varyStart(variationToMicroseconds(startVariation));
+    varyDuration(variationToMicroseconds(durationVariation));
     defer();
 }
 
 template <unsigned int N>
 Effect<N>::~Effect() {
     if (this->recall) {
-        for (auto channel: *this->channels) {
-            channel->recall(true);
+        for (int i = 0; i < N; ++i) {
+            if (drives(i)) {
+                (*this->channels)[i]->recall(true);
+            }
         }
     }
     if (this->verbose) {
@@ -157,6 +162,9 @@ bool Effect<N>::complete() {
         return true;
     } else if (!this->holds.empty()) {
         return false;
+    } else if (analytic() && (this->position < this->duration)) {
+        // Intermediate keyframes may differ from the target
+        return false;
     }
     return targetReached();
 }
@@ -164,7 +172,7 @@ bool Effect<N>::complete() {
 template <unsigned int N>
 bool Effect<N>::targetReached() {
     for (int i = 0; i < N; ++i) {
-        if ((*this->channels)[i]->get() != this->target[i]) {
+        if (drives(i) && ((*this->channels)[i]->get() != this->target[i])) {
             return false;
         }
     }
@@ -187,6 +195,13 @@ uint32_t Effect<N>::secondsToMicroseconds(double seconds) {
     return (seconds * 1000000);
 }
 
+template <unsigned int N>
+int32_t Effect<N>::variationToMicroseconds(double seconds) {
+    // Variation boundaries are limited to +/- ~35 minutes
+    uint32_t microseconds = secondsToMicroseconds(seconds);
+    return (microseconds <= INT32_MAX ? microseconds : INT32_MAX);
+}
+
 template <unsigned int N>
 void Effect<N>::setDuration(double seconds) {
     uint32_t microseconds = secondsToMicroseconds(seconds);
@@ -221,41 +236,45 @@ void Effect<N>::updateTimers(double duration, uint32_t absoluteStart) {
     }
     setDuration(duration);
     this->start = absoluteStart;
+    this->end = (this->start + this->duration);
+    defer();
 }
 
 template <unsigned int N>
-int16_t Effect<N>::vary(int32_t boundary, uint32_t& var) {
-    if (!boundary) {
+int32_t Effect<N>::vary(int32_t boundary) {
+    // Uniform offset within +/- boundary microseconds
+    if (boundary <= 0) {
         return 0;
     }
-    srand(micros());
-    int16_t variance = rand();
-    if (abs(variance) < boundary && (
-            (var + variance) > *this->now
-        )) {
-        var += variance;
-    }
-    return variance;
+    return (this->random != nullptr ? this->random : &Random::shared())->range(boundary);
 }
 
 template <unsigned int N>
 void Effect<N>::varyStart(int32_t boundary) {
-    this->end += vary(boundary, this->start);
+    // Randomizes start time, but never into the past
+    int32_t variance = vary(boundary);
+    if (static_cast<int32_t>((this->start + variance) - *this->now) >= 0) {
+        this->start += variance;
+        this->end += variance;
+    }
 }
 
 template <unsigned int N>
 void Effect<N>::varyDuration(int32_t boundary) {
-    vary(boundary, this->duration);
+    int64_t varied = (static_cast<int64_t>(this->duration) + vary(boundary));
+    this->duration = (varied >= 1 ? varied : 1); // Minimum 1 microsecond
     this->end = this->start + this->duration;
 }
 
 template <unsigned int N>
 void Effect<N>::hold(double durationInSeconds, double timeIndex) {
     // Sets a hold in seconds that starts at timeIndex (0 - 1 effect completion)
-    if (ESP.getFreeHeap() < 32768) {
-        print("\tInsufficient memory for hold creation");
-        return;
-    }
+    #ifdef IS_EMBEDDED
+        if (ESP.getFreeHeap() < 32768) {
+            print("\tInsufficient memory for hold creation");
+            return;
+        }
+    #endif
     Hold* created = new Hold(durationInSeconds, timeIndex);
     created->verbose = this->verbose;
     this->holds.push_back(created);
@@ -297,17 +316,30 @@ void Effect<N>::activate() {
     }
     this->active = true;
     for (int i = 0; i < N; ++i) {
-        (*this->channels)[i]->setTarget(this->target[i]);
+        if (drives(i)) {
+            (*this->channels)[i]->setTarget(this->target[i]);
+        }
     }
-    if (!getSteps()) {
+    if (analytic()) {
+        // Eased fades count microseconds instead of channel increments
+        for (int i = 0; i < N; ++i) {
+            this->origin[i] = (*this->channels)[i]->get();
+        }
+        this->position = 0;
+        this->stepsRemaining = this->duration;
+        this->totalSteps = this->stepsRemaining;
+    } else if (!getSteps()) {
         return;
     }
     this->start = *this->now;
     this->end = *this->now + this->duration;
-    // this->last = *this->now;
-    this->last = micros();
+    this->last = *this->now;
     this->stepLength = (this->duration / this->stepsRemaining);
     this->stepLength = (this->stepLength ? this->stepLength : 1);
+    for (auto hold: this->holds) {
+        // Holds set before activation are placed by their time index
+        hold->init(this->totalSteps);
+    }
     if (!this->secondaryHolds.empty()) {
         for (auto saved: this->secondaryHolds) {
             saved->init(this->totalSteps);
@@ -333,13 +365,17 @@ void Effect<N>::activate() {
 
 template <unsigned int N>
 uint32_t Effect<N>::getSteps() {
-    for (auto channel: *this->channels) {
-        channel->getDelta();
-        if (channel->delta > this->stepsRemaining) {
-            this->stepsRemaining = channel->delta;
+    for (int i = 0; i < N; ++i) {
+        if (drives(i) && ((*this->channels)[i]->getDelta() > this->stepsRemaining)) {
+            this->stepsRemaining = (*this->channels)[i]->delta;
+        }
+    }
+    this->totalSteps = this->stepsRemaining;
+    // Every channel spreads its change over the longest channel's steps
+    for (int i = 0; i < N; ++i) {
+        if (drives(i)) {
+            (*this->channels)[i]->calculate(this->stepsRemaining);
         }
-        this->totalSteps = this->stepsRemaining;
-        channel->calculate(this->stepsRemaining);
     }
     this->aborted = (!this->stepsRemaining);
     return this->stepsRemaining;
@@ -362,7 +398,7 @@ bool Effect<N>::holding() {
                 current->init(this->totalSteps);
             }
         } else {
-            if (current->step(this->stepsRemaining)) {
+            if (current->step(this->stepsRemaining, *this->now)) {
                 this->last = *this->now;
                 return true;
             }
@@ -371,10 +407,68 @@ bool Effect<N>::holding() {
     return false;
 }
 
+template <unsigned int N>
+bool Effect<N>::held() {
+    // Whether the current hold is active, without advancing it
+    return (!this->holds.empty() && this->holds.front()->active);
+}
+
+template <unsigned int N>
+bool Effect<N>::drives(int channel) {
+    // Whether the channel is included in this effect's mask
+    return ((this->mask >> channel) & 1);
+}
+
+template <unsigned int N>
+bool Effect<N>::analytic() {
+    // Whether output is evaluated from elapsed time rather than stepped
+    return (this->easing != nullptr);
+}
+
+template <unsigned int N>
+bool Effect<N>::indefinite() {
+    // Whether the effect runs until cancelled instead of completing
+    return false;
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> Effect<N>::evaluate(
+        uint32_t position, const std::array<uint16_t, N>& from
+    ) {
+    // Color at position microseconds into the fade from the given origin
+    const Easing* curve = (this->easing != nullptr ? this->easing : Easing::get(Easing::LINEAR));
+    uint16_t progress = Easing::progress(position, this->duration);
+    std::array<uint16_t, N> values;
+    for (int i = 0; i < N; ++i) {
+        values[i] = (drives(i) ? curve->interpolate(from[i], this->target[i], progress) : from[i]);
+    }
+    return values;
+}
+
+template <unsigned int N>
+void Effect<N>::apply(const std::array<uint16_t, N>& values) {
+    for (int i = 0; i < N; ++i) {
+        if (drives(i)) {
+            (*this->channels)[i]->value = values[i];
+            (*this->channels)[i]->write();
+        }
+    }
+}
+
 template <unsigned int N>
 void Effect<N>::step() {
     // Measures elapsed time and compensates
-    uint32_t elapsed = micros() - this->last;
+    uint32_t elapsed = *this->now - this->last;
+    if (analytic()) {
+        // Constant cost per tick regardless of elapsed time
+        if (elapsed && !holding() && (this->stepsRemaining > 0)) {
+            this->last += elapsed;
+            this->position = std::min(this->position + elapsed, this->duration);
+            this->stepsRemaining = (this->duration - this->position);
+            apply(evaluate(this->position, this->origin));
+        }
+        return;
+    }
     if (elapsed && !holding() && (this->stepsRemaining > 0)) {
         int64_t iterations = elapsed / this->stepLength;
         if (iterations >= 1) {
@@ -384,7 +478,11 @@ void Effect<N>::step() {
                 );
             for (int i = 0; i < iterations; i++) {
                 this->stepsRemaining--;
-                for (auto channel: *this->channels) {
+                for (int j = 0; j < N; ++j) {
+                    if (!drives(j)) {
+                        continue;
+                    }
+                    ColorChannel* channel = (*this->channels)[j];
                     channel->step();
                     if (!this->stepsRemaining && !targetReached()) {
                         while (channel->fading()) {
@@ -392,8 +490,9 @@ void Effect<N>::step() {
                         }
                     }
                 }
-                this->last = micros();
             }
+            // Carry the remainder so fade length doesn't depend on tick rate
+            this->last += (iterations * this->stepLength);
         }
     }
 }
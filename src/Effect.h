@@ -26,35 +26,44 @@
 #define EFFECT_H
 
 #include <array>
+#include <vector>
 #include "ColorChannel.h"
+#include "Easing.h"
+#include "Random.h"
 
 class Hold : public SimpleSerialBase {
     public:
         bool active = false, complete = false, verbose = false;
         double start = 1; // 0 - 1 amount of effect completed to trigger hold
         uint32_t last, threshold = 0; // Descending effect step count to activate
-        int64_t duration, remaining = 0;
+        int64_t duration = 0, remaining = 0;
         Hold(double, double startThreshold=1);
         ~Hold();
         void init(uint32_t);
         void status();
-        bool step(uint32_t);
+        bool step(uint32_t stepsRemaining, uint32_t now);
 };
 
 template <unsigned int N=3>
 class Effect : public SimpleSerialBase {
     protected:
-        int16_t vary(int32_t, uint32_t&);
+        int32_t vary(int32_t);
     public:
         bool
             verbose = false, active = false, recall = false,
             deferOnRollover = true, aborted = false;
         uint32_t
             *now, last, start, end, duration, uid,
-            stepLength = 1, stepsRemaining = 0, totalSteps = 0;
+            stepLength = 1, stepsRemaining = 0, totalSteps = 0,
+            position = 0; // Microseconds into an eased fade
         int32_t loop = 0;
+        uint32_t mask = 0xFFFFFFFF; // Channels driven by this effect, one bit each
+        const Easing* easing = nullptr; // Linear stepping when null
+        Random* random = nullptr; // Source for start and duration variation
+        Effect<N> *uidPrevious = nullptr, *uidNext = nullptr; // Effects sharing uid
+        int32_t scheduled = -1; // Scheduler heap position; -1 if not scheduled
         std::array<uint16_t*, N> current, globalLast;
-        std::array<uint16_t, N> target;
+        std::array<uint16_t, N> target, origin;
         std::array<ColorChannel*, N>* channels;
         std::vector<Hold*> holds, secondaryHolds;
         Effect(
@@ -67,13 +76,16 @@ class Effect : public SimpleSerialBase {
                 double startVariation=0,
                 double durationVariation=0,
                 uint32_t uid=0,
-                int32_t loop=0
+                int32_t loop=0,
+                const Easing* easing=nullptr,
+                Random* random=nullptr
             );
-        ~Effect();
-        bool complete();
+        virtual ~Effect();
+        virtual bool complete();
         bool targetReached();
         void cancel();
         static uint32_t secondsToMicroseconds(double);
+        static int32_t variationToMicroseconds(double);
         void setDuration(double seconds=1e-6);
         void defer();
         void adjust(int64_t delta);
@@ -86,17 +98,23 @@ class Effect : public SimpleSerialBase {
         void clearHolds();
         uint32_t getSteps();
         bool holding();
-        void step();
+        bool held();
+        bool drives(int channel);
+        virtual bool analytic();
+        virtual bool indefinite();
+        virtual std::array<uint16_t, N> evaluate(uint32_t position, const std::array<uint16_t, N>& from);
+        void apply(const std::array<uint16_t, N>&);
+        virtual void step();
         bool run();
         void status();
 };
 
-#endif
-
 template class Effect<1>;
 template class Effect<2>;
 template class Effect<3>;
 template class Effect<4>;
 template class Effect<5>;
 
+#endif
+
 // #include <Effect.cpp>
\ No newline at end of file
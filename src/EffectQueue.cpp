@@ -0,0 +1,244 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "EffectQueue.h"
+
+template <unsigned int N>
+EffectQueue<N>::EffectQueue(
+        std::array<ColorChannel*, N>* channels, uint32_t* now, uint32_t mask, size_t reserve
+    ) {
+    // Owners size the queue; LedWriter reserves its own in init()
+    this->queueChannels = channels;
+    this->clock = now;
+    this->mask = mask;
+    this->effects.reserve(reserve);
+}
+
+template <unsigned int N>
+EffectQueue<N>::~EffectQueue() {
+    clearEffects();
+}
+
+template <unsigned int N>
+Effect<N>* EffectQueue<N>::enqueue(Effect<N>* created) {
+    // Takes ownership of an effect built against this queue's channels
+    if (this->effects.size() >= MAX_LAYER_EFFECTS) {
+        print("Insufficient memory for effect creation");
+        delete created;
+        return nullptr;
+    }
+    created->verbose = this->verbose;
+    created->mask &= this->mask;
+    this->effects.push_back(created);
+    if (this->uidIndex != nullptr) {
+        this->uidIndex->insert(created);
+    }
+    this->revision++;
+    return created;
+}
+
+template <unsigned int N>
+Effect<N>* EffectQueue<N>::createEffect(
+        std::array<uint16_t, N> target,
+        double duration, double relativeStart,
+        uint32_t effectUID, int32_t loop,
+        const Easing* easing
+    ) {
+    uint32_t absoluteStart = *this->clock;
+    if ((relativeStart > 0) && (relativeStart <= 4294.967296)) {
+        absoluteStart += static_cast<uint32_t>(relativeStart * 1000000);
+    }
+    return enqueue(new Effect<N>(
+            target, this->queueChannels, this->clock,
+            duration, false, absoluteStart,
+            0, 0, effectUID, loop, easing
+        ));
+}
+
+template <unsigned int N>
+Generator<N>* EffectQueue<N>::createGenerator(
+        std::array<Oscillator, N> oscillators,
+        double relativeStart, uint32_t effectUID
+    ) {
+    uint32_t absoluteStart = *this->clock;
+    if ((relativeStart > 0) && (relativeStart <= 4294.967296)) {
+        absoluteStart += static_cast<uint32_t>(relativeStart * 1000000);
+    }
+    return static_cast<Generator<N>*>(enqueue(new Generator<N>(
+            oscillators, this->queueChannels, this->clock, absoluteStart, effectUID
+        )));
+}
+
+template <unsigned int N>
+uint32_t EffectQueue<N>::effectsQueued() {
+    return (this->effects.size());
+}
+
+template <unsigned int N>
+void EffectQueue<N>::cycleEffects() {
+    if (this->effect != nullptr) {
+        if (this->effect->complete() && !this->effect->active) {
+            notify(
+                    ((this->effect->loop != 0) ? EffectEvent<N>::LOOPED : EffectEvent<N>::COMPLETED),
+                    this->effect
+                );
+            // notify() may have cleared the queue, this effect included
+            if (this->effect != nullptr) {
+                if (this->effect->loop != 0) {
+                    this->effect->aborted = false;
+                    this->effect->position = 0;
+                    this->effect->last = *this->clock;
+                    this->effect->start = *this->clock;
+                    if (this->uidIndex != nullptr) {
+                        this->uidIndex->remove(this->effect);
+                    }
+                    this->effect->uid = this->effects.back()->uid + 1;
+                    if (this->uidIndex != nullptr) {
+                        this->uidIndex->insert(this->effect);
+                    }
+                    if (this->effect->loop > 0) {
+                        this->effect->loop--;
+                    }
+                    this->effects.push_back(this->effect);
+                } else {
+                    if (this->uidIndex != nullptr) {
+                        this->uidIndex->remove(this->effect);
+                    }
+                    delete this->effect;
+                    this->effect = nullptr;
+                }
+                this->effects.erase(this->effects.begin());
+            }
+            this->effect = (effectsQueued() ? this->effects.front() : nullptr);
+            this->revision++;
+            if (!effectsQueued()) {
+                notify(EffectEvent<N>::DRAINED, nullptr);
+            }
+        } else {
+            Effect<N>* running = this->effect;
+            bool held = running->held();
+            if (running->run()) {
+                notify(EffectEvent<N>::ACTIVATED, running);
+            } else if (held != running->held()) {
+                notify((held ? EffectEvent<N>::HOLD_ENDED : EffectEvent<N>::HOLD_STARTED), running);
+            }
+        }
+    } else if (effectsQueued()) {
+        print("Setting effect");
+        this->effect = this->effects.front();
+    }
+}
+
+template <unsigned int N>
+void EffectQueue<N>::clearEffects() {
+    for (auto queued: this->effects) {
+        if (this->uidIndex != nullptr) {
+            this->uidIndex->remove(queued);
+        }
+        delete queued;
+    }
+    this->effects.clear();
+    this->effect = nullptr;
+    this->revision++;
+}
+
+template <unsigned int N>
+void EffectQueue<N>::notify(uint8_t type, Effect<N>* effect) {
+    // Called as effects change state; nothing to do for a plain queue
+    (void) type;
+    (void) effect;
+}
+
+template <unsigned int N>
+Layer<N>::Layer(
+        uint8_t resolution, uint32_t* now, uint8_t blend, double opacity
+    ) : EffectQueue<N>(&this->layerChannels, now, 0xFFFFFFFF, MAX_LAYER_EFFECTS) {
+    // Layers render into unattached channels that start dark
+    for (int i = 0; i < N; ++i) {
+        this->layerChannels[i] = new ColorChannel(0, i, resolution, 0, false);
+        this->layerChannels[i]->set(0, true);
+        this->layerChannels[i]->setTarget(0);
+        this->layerChannels[i]->save();
+    }
+    this->absoluteMaximum = this->layerChannels[0]->absoluteMaximum;
+    this->blend = blend;
+    setOpacity(opacity);
+}
+
+template <unsigned int N>
+Layer<N>::~Layer() {
+    // Effects reference layer channels, so they go first
+    this->clearEffects();
+    for (auto channel: this->layerChannels) {
+        delete channel;
+    }
+}
+
+template <unsigned int N>
+void Layer<N>::clearEffects() {
+    EffectQueue<N>::clearEffects();
+    this->content = false;
+}
+
+template <unsigned int N>
+void Layer<N>::notify(uint8_t type, Effect<N>* effect) {
+    (void) effect;
+    if (type == EffectEvent<N>::ACTIVATED) {
+        this->content = true;
+    }
+}
+
+template <unsigned int N>
+void Layer<N>::setOpacity(double value) {
+    value = (value <= 1 ? value : 1); // Maximum 1
+    value = (value >= 0 ? value : 0); // Minimum 0
+    this->opacity = (value * 65535);
+}
+
+template <unsigned int N>
+uint16_t Layer<N>::composite(int channel, uint16_t base) {
+    // Blends this layer over a lower value; no allocation, constant time
+    if (!this->content) {
+        return base;
+    }
+    int32_t value = this->layerChannels[channel]->value, blended;
+    switch (this->blend) {
+        case REPLACE:
+            return value;
+        case ADD:
+            blended = std::min<int32_t>(base + value, this->absoluteMaximum);
+            break;
+        case MULTIPLY:
+            blended = ((base * value) / this->absoluteMaximum);
+            break;
+        case HTP:
+            blended = std::max<int32_t>(base, value);
+            break;
+        default:
+            // Crossfade
+            blended = value;
+            break;
+    }
+    return (base + (((blended - base) * static_cast<int64_t>(this->opacity)) / 65535));
+}
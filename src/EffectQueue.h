@@ -0,0 +1,122 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef EFFECTQUEUE_H
+#define EFFECTQUEUE_H
+
+#include <vector>
+#include "Effect.h"
+#include "Generator.h"
+#include "UidIndex.h"
+
+#define MAX_LAYER_EFFECTS       100 // Reserved up front by each track and layer
+
+template <unsigned int N> class LedWriter;
+
+template <unsigned int N=4>
+struct EffectEvent {
+    // Types are bit flags so listeners can choose which they receive
+    enum Type : uint8_t {
+        ACTIVATED = 1, HOLD_STARTED = 2, HOLD_ENDED = 4,
+        LOOPED = 8, // A pass finished and the effect was queued again
+        COMPLETED = 16, // The last pass finished; the effect is deleted after
+        DRAINED = 32, // Nothing left queued or scheduled
+        ALL = 63
+    };
+    uint8_t type;
+    uint32_t uid, time;
+    Effect<N>* effect; // Null once a listener clears the queue, and for DRAINED
+    LedWriter<N>* writer;
+};
+
+template <unsigned int N=3>
+class EffectQueue : public SimpleSerialBase {
+    /* A FIFO of effects played one after another. LedWriter runs its base
+    queue through this, as do tracks and layers; notify() is where
+    subclasses react as effects change state. */
+    public:
+        std::array<ColorChannel*, N>* queueChannels;
+        uint32_t* clock;
+        uint32_t mask = 0xFFFFFFFF; // Applied to every effect queued here
+        uint32_t revision = 0; // Bumped whenever queue contents or timing change
+        std::vector<Effect<N>*> effects;
+        Effect<N>* effect = nullptr;
+        UidIndex<N>* uidIndex = nullptr; // Kept in step with the queue when set
+        EffectQueue(
+                std::array<ColorChannel*, N>* channels=nullptr, uint32_t* now=nullptr,
+                uint32_t mask=0xFFFFFFFF, size_t reserve=0
+            );
+        virtual ~EffectQueue();
+        Effect<N>* enqueue(Effect<N>*);
+        Effect<N>* createEffect(
+                std::array<uint16_t, N> target,
+                double duration=1e-6, double relativeStart=0,
+                uint32_t effectUID=0, int32_t loop=0,
+                const Easing* easing=nullptr
+            );
+        Generator<N>* createGenerator(
+                std::array<Oscillator, N> oscillators,
+                double relativeStart=0, uint32_t effectUID=0
+            );
+        uint32_t effectsQueued();
+        void cycleEffects();
+        void clearEffects();
+        virtual void notify(uint8_t type, Effect<N>* effect);
+};
+
+template <unsigned int N=3>
+class Layer : public EffectQueue<N> {
+    public:
+        enum Blend : uint8_t {
+            REPLACE, // The layer's value outright; opacity is ignored
+            ADD,
+            MULTIPLY,
+            HTP, // Highest takes precedence
+            CROSSFADE // Leans from the lower value toward the layer by opacity
+        };
+        std::array<ColorChannel*, N> layerChannels;
+        uint8_t blend;
+        uint16_t opacity = 65535, absoluteMaximum;
+        bool content = false; // Set once an effect runs; until then the layer is transparent
+        Layer(uint8_t resolution, uint32_t* now, uint8_t blend=REPLACE, double opacity=1);
+        ~Layer();
+        void setOpacity(double);
+        uint16_t composite(int channel, uint16_t base);
+        void clearEffects();
+        void notify(uint8_t type, Effect<N>* effect) override;
+};
+
+template class EffectQueue<1>;
+template class EffectQueue<2>;
+template class EffectQueue<3>;
+template class EffectQueue<4>;
+template class EffectQueue<5>;
+
+template class Layer<1>;
+template class Layer<2>;
+template class Layer<3>;
+template class Layer<4>;
+template class Layer<5>;
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "FixtureManager.h"
+#include <new>
+
+#ifndef IS_EMBEDDED
+    #include <chrono>
+#endif
+
+template <unsigned int N>
+FixtureManager<N>::FixtureManager(uint32_t capacity) {
+    // Writers are constructed in place as they are added
+    this->capacity = capacity;
+    this->fixtures = static_cast<LedWriter<N>*>(::operator new(sizeof(LedWriter<N>) * capacity));
+    this->timeIndex = sampleClock();
+}
+
+template <unsigned int N>
+FixtureManager<N>::~FixtureManager() {
+    stopTasks();
+    for (uint32_t i = 0; i < this->count; ++i) {
+        this->fixtures[i].~LedWriter<N>();
+    }
+    ::operator delete(this->fixtures);
+    this->fixtures = nullptr;
+}
+
+template <unsigned int N>
+LedWriter<N>* FixtureManager<N>::add(std::array<uint8_t, N> pins, uint8_t resolution, bool on) {
+    if (this->count >= this->capacity) {
+        print("Fixture capacity reached");
+        return nullptr;
+    }
+    #if ESP32 || ESP8266
+        if ((this->nextChannel + N) > LEDC_CHANNELS) {
+            print("Out of LEDC channels for another fixture");
+            return nullptr;
+        }
+    #endif
+    LedWriter<N>* writer = new (&this->fixtures[this->count]) LedWriter<N>(pins, resolution, on, this->nextChannel);
+    writer->now = this->now;
+    this->nextChannel += N;
+    this->count++;
+    return writer;
+}
+
+template <unsigned int N>
+LedWriter<N>& FixtureManager<N>::operator[](uint32_t index) {
+    return this->fixtures[index];
+}
+
+template <unsigned int N>
+uint32_t FixtureManager<N>::size() {
+    return this->count;
+}
+
+template <unsigned int N>
+uint32_t FixtureManager<N>::sampleClock() {
+    #ifdef IS_EMBEDDED
+        return micros();
+    #else
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count());
+    #endif
+}
+
+template <unsigned int N>
+void FixtureManager<N>::run() {
+    // One clock read per frame, shared by every fixture
+    uint32_t sampled = sampleClock();
+    this->now += (sampled - this->timeIndex);
+    this->timeIndex = sampled;
+    run(this->now);
+}
+
+template <unsigned int N>
+void FixtureManager<N>::run(uint32_t currentTime) {
+    this->now = currentTime;
+    if (!this->split) {
+        tick(0, this->count);
+        return;
+    }
+    /* The second core takes fixtures from the split point up; this one
+    takes the rest, then waits so the frame completes as a unit. */
+    #if ESP32
+        this->callerTask = xTaskGetCurrentTaskHandle();
+        xTaskNotifyGive(this->workerTask);
+        tick(0, this->split);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    #elif !defined(IS_EMBEDDED)
+        uint32_t target = (this->frame.fetch_add(1, std::memory_order_release) + 1);
+        tick(0, this->split);
+        while (this->finished.load(std::memory_order_acquire) != target) {
+            std::this_thread::yield();
+        }
+    #endif
+}
+
+template <unsigned int N>
+void FixtureManager<N>::tick(uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        this->fixtures[i].run(this->now);
+    }
+}
+
+template <unsigned int N>
+void FixtureManager<N>::worker(void* parameter) {
+    FixtureManager<N>* manager = static_cast<FixtureManager<N>*>(parameter);
+    #if ESP32
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            manager->tick(manager->split, manager->count);
+            xTaskNotifyGive(manager->callerTask);
+        }
+    #elif !defined(IS_EMBEDDED)
+        // Frames are only issued after the previous one finished
+        uint32_t seen = manager->finished.load(std::memory_order_acquire);
+        while (manager->running.load(std::memory_order_relaxed)) {
+            uint32_t current = manager->frame.load(std::memory_order_acquire);
+            if (current == seen) {
+                std::this_thread::yield();
+                continue;
+            }
+            seen = current;
+            manager->tick(manager->split, manager->count);
+            manager->finished.store(seen, std::memory_order_release);
+        }
+    #endif
+}
+
+template <unsigned int N>
+void FixtureManager<N>::startTasks() {
+    /* Splits the fixtures in half across two cores. Add every fixture
+    before starting; run() must then be called from one task only. */
+    if (this->split || (this->count < 2)) {
+        return;
+    }
+    #if ESP32
+        this->split = (this->count / 2);
+        // Caller runs on core 1 under Arduino; the worker takes core 0
+        xTaskCreatePinnedToCore(worker, "fixtures", 16384, this, 1, &this->workerTask, 0);
+    #elif !defined(IS_EMBEDDED)
+        this->split = (this->count / 2);
+        this->running.store(true);
+        this->workerThread = std::thread(worker, this);
+    #else
+        print("Single core; fixtures run in the calling task");
+    #endif
+}
+
+template <unsigned int N>
+void FixtureManager<N>::stopTasks() {
+    if (!this->split) {
+        return;
+    }
+    #if ESP32
+        vTaskDelete(this->workerTask);
+        this->workerTask = nullptr;
+    #elif !defined(IS_EMBEDDED)
+        this->running.store(false);
+        this->workerThread.join();
+    #endif
+    this->split = 0;
+}
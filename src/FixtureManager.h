@@ -0,0 +1,75 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef FIXTUREMANAGER_H
+#define FIXTUREMANAGER_H
+
+#include <stdint.h>
+#include "LedWriter.h"
+
+#ifndef IS_EMBEDDED
+    #include <atomic>
+    #include <thread>
+#endif
+
+template <unsigned int N=3>
+class FixtureManager : public SimpleSerialBase {
+    /* Owns many writers in one contiguous block and ticks them all from
+    a single clock sample per frame, in place of a task and a clock read
+    per writer. Optionally splits the block across two cores. Each
+    fixture takes the next N hardware channels. */
+    public:
+        LedWriter<N>* fixtures;
+        uint32_t count = 0, capacity, split = 0;
+        uint8_t nextChannel = 0;
+        uint32_t now = 0, timeIndex = 0;
+        FixtureManager(uint32_t capacity);
+        ~FixtureManager();
+        LedWriter<N>* add(std::array<uint8_t, N> pins, uint8_t resolution=10, bool on=true);
+        LedWriter<N>& operator[](uint32_t index);
+        uint32_t size();
+        void run();
+        void run(uint32_t currentTime);
+        void startTasks();
+        void stopTasks();
+        static uint32_t sampleClock();
+    protected:
+        void tick(uint32_t begin, uint32_t end);
+        static void worker(void* parameter);
+        #if ESP32
+            TaskHandle_t workerTask = nullptr, callerTask = nullptr;
+        #elif !defined(IS_EMBEDDED)
+            std::thread workerThread;
+            std::atomic<uint32_t> frame{0}, finished{0};
+            std::atomic<bool> running{false};
+        #endif
+};
+
+template class FixtureManager<1>;
+template class FixtureManager<2>;
+template class FixtureManager<3>;
+template class FixtureManager<4>;
+template class FixtureManager<5>;
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Generator.h"
+#include <algorithm>
+#include <cmath>
+
+template <unsigned int N>
+Generator<N>::Generator(
+        std::array<Oscillator, N> oscillators,
+        std::array<ColorChannel*, N>* channels,
+        uint32_t* now,
+        uint32_t absoluteStart,
+        uint32_t uid
+    ) : Effect<N>(
+            std::array<uint16_t, N>{}, channels, now,
+            0, false, absoluteStart, 0, 0, uid, 0
+        ) {
+    this->oscillators = oscillators;
+    this->seed = uid;
+    for (int i = 0; i < N; ++i) {
+        Oscillator& oscillator = this->oscillators[i];
+        double frequency = (oscillator.frequency >= 0 ? oscillator.frequency : 0);
+        double offset = (oscillator.phase - std::floor(oscillator.phase));
+        double duty = (oscillator.duty <= 1 ? (oscillator.duty >= 0 ? oscillator.duty : 0) : 1);
+        // Fixed-point rates keep phase exact however long the generator runs
+        this->rate[i] = std::llround(frequency * 281474976710656.0 / 1e6);
+        this->phase[i] = std::llround(offset * 281474976710656.0);
+        this->duty[i] = std::lround(duty * 65535);
+    }
+}
+
+template <unsigned int N>
+uint16_t Generator<N>::sine(uint16_t phase) {
+    // 0 - 65535 output over one 0 - 65535 cycle, starting at midpoint
+    static const std::array<uint16_t, 257> table = []() {
+        std::array<uint16_t, 257> values;
+        for (int i = 0; i < 257; ++i) {
+            values[i] = std::lround((std::sin(i * 2 * M_PI / 256) + 1) * 32767.5);
+        }
+        return values;
+    }();
+    uint16_t index = (phase >> 8);
+    int32_t fraction = (phase & 0xFF);
+    int32_t first = table[index], second = table[index + 1];
+    return (first + (((second - first) * fraction) >> 8));
+}
+
+template <unsigned int N>
+uint16_t Generator<N>::noise(uint32_t cycle, uint32_t seed) {
+    // Stateless integer hash; the same cycle always yields the same level
+    uint32_t hashed = (cycle * 0x9E3779B1) ^ seed;
+    hashed ^= (hashed >> 16);
+    hashed *= 0x85EBCA6B;
+    hashed ^= (hashed >> 13);
+    hashed *= 0xC2B2AE35;
+    hashed ^= (hashed >> 16);
+    return (hashed >> 16);
+}
+
+template <unsigned int N>
+uint16_t Generator<N>::wave(int channel, uint64_t runtime) {
+    // Output level 0 - 65535 for one channel
+    uint64_t position = (this->phase[channel] + (runtime * this->rate[channel]));
+    uint16_t cycle = (position >> 48), fraction = (position >> 32);
+    switch (this->oscillators[channel].waveform) {
+        case SINE:
+            return sine(fraction);
+        case TRIANGLE:
+            return (fraction < 32768 ? (fraction * 2) : ((65535 - fraction) * 2));
+        case SQUARE:
+            return (fraction < this->duty[channel] ? 65535 : 0);
+        case SAWTOOTH:
+            return fraction;
+        case NOISE: {
+            // Value noise; random levels at whole cycles, smoothstep between
+            uint32_t key = (this->seed + channel);
+            int32_t first = noise(cycle, key), second = noise(cycle + 1, key);
+            uint64_t weight = fraction;
+            weight = ((((weight * weight) >> 16) * (196608 - (2 * weight))) >> 16);
+            return (first + (((second - first) * static_cast<int64_t>(weight)) >> 16));
+        }
+        default:
+            return 0;
+    }
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> Generator<N>::sample(uint64_t runtime) {
+    std::array<uint16_t, N> values;
+    for (int i = 0; i < N; ++i) {
+        uint32_t scaled = ((static_cast<uint32_t>(wave(i, runtime)) * this->oscillators[i].amplitude) / 65535);
+        // Clamp before conform() so offset plus swing cannot wrap past full scale
+        values[i] = (*this->channels)[i]->conform(std::min<uint32_t>(this->oscillators[i].offset + scaled, 65535));
+    }
+    return values;
+}
+
+template <unsigned int N>
+bool Generator<N>::analytic() {
+    return true;
+}
+
+template <unsigned int N>
+bool Generator<N>::complete() {
+    // Runs indefinitely until cancelled
+    return this->aborted;
+}
+
+template <unsigned int N>
+bool Generator<N>::indefinite() {
+    return true;
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> Generator<N>::evaluate(
+        uint32_t position, const std::array<uint16_t, N>& from
+    ) {
+    std::array<uint16_t, N> values = sample(position);
+    for (int i = 0; i < N; ++i) {
+        values[i] = (this->drives(i) ? values[i] : from[i]);
+    }
+    return values;
+}
+
+template <unsigned int N>
+void Generator<N>::step() {
+    uint32_t elapsed = *this->now - this->last;
+    // Nothing is left to fade, so each hold starts as the last one ends
+    this->stepsRemaining = 0;
+    if (elapsed) {
+        if (!this->holding()) {
+            this->last += elapsed;
+            this->runtime += elapsed;
+            this->position = this->runtime;
+        }
+        this->apply(sample(this->runtime));
+    }
+}
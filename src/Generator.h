@@ -0,0 +1,82 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "Effect.h"
+
+struct Oscillator {
+    uint8_t waveform = 0; // Generator::Waveform
+    double frequency = 1; // Cycles per second
+    double phase = 0; // 0 - 1 cycle offset at activation
+    uint16_t amplitude = 0; // Peak-to-peak output
+    uint16_t offset = 0; // Output at the bottom of each cycle
+    double duty = .5; // 0 - 1 fraction of cycle held high by square waves
+};
+
+template <unsigned int N=3>
+class Generator : public Effect<N> {
+    public:
+        enum Waveform : uint8_t {
+            SINE,
+            TRIANGLE,
+            SQUARE,
+            SAWTOOTH,
+            NOISE
+        };
+        std::array<Oscillator, N> oscillators;
+        // Cycle position per channel in units of 2^-48 cycles; wraps every 65536 cycles
+        std::array<uint64_t, N> phase, rate;
+        std::array<uint16_t, N> duty;
+        uint64_t runtime = 0; // Microseconds since activation, excluding holds
+        // Holds freeze the waveform in turn from activation; their time index is unused
+        uint32_t seed;
+        Generator(
+                std::array<Oscillator, N> oscillators,
+                std::array<ColorChannel*, N>* channels,
+                uint32_t* now,
+                uint32_t absoluteStart=0,
+                uint32_t uid=0
+            );
+        static uint16_t sine(uint16_t);
+        static uint16_t noise(uint32_t cycle, uint32_t seed);
+        uint16_t wave(int, uint64_t);
+        std::array<uint16_t, N> sample(uint64_t);
+        bool analytic() override;
+        bool complete() override;
+        bool indefinite() override;
+        std::array<uint16_t, N> evaluate(
+                uint32_t position, const std::array<uint16_t, N>& from
+            ) override;
+        void step() override;
+};
+
+template class Generator<1>;
+template class Generator<2>;
+template class Generator<3>;
+template class Generator<4>;
+template class Generator<5>;
+
+#endif
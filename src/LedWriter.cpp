@@ -67,11 +67,29 @@ bool GlobalSave<N>::recallInquiry(uint32_t uid)
     return (this->enabled && (uid == this->recallUID));
 }
 
+template <unsigned int N>
+void GlobalSave<N>::react(const EffectEvent<N>& event, void* context)
+{
+    // Saves as the save UID activates and recalls as the recall UID finishes
+    GlobalSave<N>* global = static_cast<GlobalSave<N>*>(context);
+    if (event.type == EffectEvent<N>::ACTIVATED)
+    {
+        if (global->saveInquiry(event.uid))
+        {
+            event.writer->save(true);
+        }
+    }
+    else if (global->recallInquiry(event.uid))
+    {
+        event.writer->recall(true, true, true);
+    }
+}
+
 template <unsigned int N>
 LedWriter<N>::LedWriter(
-        std::array<uint8_t, N> pinArray, uint8_t resolution, bool on
+        std::array<uint8_t, N> pinArray, uint8_t resolution, bool on, uint8_t firstChannel
     ) {
-    init(pinArray, resolution, on);
+    init(pinArray, resolution, on, firstChannel);
 }
 
 template <>
@@ -99,7 +117,8 @@ LedWriter<4>::LedWriter(uint8_t resolution, bool on) {
 }
 
 template <unsigned int N>
-void LedWriter<N>::init(std::array<uint8_t, N> pins, uint8_t resolution, bool on) {
+void LedWriter<N>::init(std::array<uint8_t, N> pins, uint8_t resolution, bool on, uint8_t firstChannel) {
+    // Hardware channels firstChannel onward; writers sharing a chip need their own ranges
     this->resolution = (resolution >= 1 && resolution <= 15 ? resolution : 8);
     uint16_t multiplied = std::pow(2, this->resolution);
     this->frequency = (80000000 / multiplied);
@@ -107,14 +126,23 @@ void LedWriter<N>::init(std::array<uint8_t, N> pins, uint8_t resolution, bool on
     this->maximum = this->absoluteMaximum;
     for (int i = 0; i < N; ++i) {
         this->channels[i] = new ColorChannel(
-                pins[i], i, this->resolution, this->frequency
+                pins[i], (firstChannel + i), this->resolution, this->frequency
             );
         this->color[i] = this->channels[i]->color;
     }
+    this->queueChannels = &this->channels;
+    this->clock = &this->now;
     this->globalSave = new GlobalSave<N>;
+    this->uidIndex = new UidIndex<N>;
+    this->scheduler = new Scheduler<N>(MAX_EFFECTS);
+    this->queueIndex = new QueueIndex<N>;
     this->globalSave->save(getCurrent());
+    listen(
+            GlobalSave<N>::react, this->globalSave,
+            (EffectEvent<N>::ACTIVATED | EffectEvent<N>::LOOPED | EffectEvent<N>::COMPLETED)
+        );
     setPolarityInversion(this->inverted);
-    this->effects.reserve(MAX_EFFECTS);
+    this->effects.reserve(EFFECTS_RESERVE);
     #ifdef IS_EMBEDDED
         this->timeIndex = micros();
     #endif
@@ -128,12 +156,26 @@ void LedWriter<N>::init(std::array<uint8_t, N> pins, uint8_t resolution, bool on
 template <unsigned int N>
 LedWriter<N>::~LedWriter() {
     clearEffects();
+    for (auto track: this->tracks) {
+        delete track;
+    }
+    this->tracks.clear();
+    for (auto layer: this->layers) {
+        delete layer;
+    }
+    this->layers.clear();
     for (auto channel: this->channels) {
         delete channel;
         channel = nullptr;
     }
     delete this->globalSave;
     this->globalSave = nullptr;
+    delete this->uidIndex;
+    this->uidIndex = nullptr;
+    delete this->scheduler;
+    this->scheduler = nullptr;
+    delete this->queueIndex;
+    this->queueIndex = nullptr;
 }
 
 template <unsigned int N>
@@ -145,6 +187,12 @@ void LedWriter<N>::setPolarityInversion(bool inverted) {
     print("Set inversion");
 }
 
+template <unsigned int N>
+void LedWriter<N>::seed(uint64_t value) {
+    // Reseeds start and duration variation so randomized runs can be replayed
+    this->random.seed(value);
+}
+
 template <unsigned int N>
 void LedWriter<N>::setScale(std::array<double, N> values) {
     for (int i = 0; i < N; ++i) {
@@ -219,6 +267,7 @@ void LedWriter<N>::set(std::array<uint16_t, N> values, bool immediate) {
         for (int i = 0; i < N; ++i) {
             this->channels[i]->set(values[i], immediate);
         }
+        this->revision++;
     } else {
         createEffect(values);
     }
@@ -230,7 +279,8 @@ Effect<N>* LedWriter<N>::createEffect(
         std::array<uint16_t, N> target,
         double duration, bool recall, double relativeStart,
         double startVariation, double durationVariation,
-        uint32_t effectUID, bool updateUID, int32_t loop
+        uint32_t effectUID, bool updateUID, int32_t loop,
+        const Easing* easing, uint32_t mask
     ) {
     uint32_t absoluteStart;
     if ((relativeStart > 0) && (relativeStart <= 4294.967296)) {
@@ -241,7 +291,7 @@ Effect<N>* LedWriter<N>::createEffect(
     return createEffectAbsolute(
             target, duration, recall, absoluteStart,
             startVariation, durationVariation,
-            effectUID, updateUID, loop
+            effectUID, updateUID, loop, easing, mask
         );
 }
 
@@ -250,20 +300,16 @@ Effect<N>* LedWriter<N>::createEffectAbsolute(
         std::array<uint16_t, N> target,
         double duration, bool recall, uint32_t absoluteStart,
         double startVariation, double durationVariation,
-        uint32_t effectUID, bool updateUID, int32_t loop
+        uint32_t effectUID, bool updateUID, int32_t loop,
+        const Easing* easing, uint32_t mask
     ) {
     bool updated = false;
-    Effect<N>* updatedEffect;
     duration = (duration ? duration : this->globalEffectDuration);
     if (updateUID) {
-        for (auto effect: this->effects) {
-            // Update specified effect if not already acitve
-            if (effect->uid == effectUID) {
-                effect->updateTimers(duration, absoluteStart);
-                updated = true;
-                updatedEffect = effect;
-                print("Updated existing effect timer");
-            }
+        // Update specified effects if not already active; keeps the scheduler in step
+        updated = (retimeEffects(effectUID, duration, absoluteStart) > 0);
+        if (updated) {
+            print("Updated existing effect timer");
         }
     }
     if (!updated) {
@@ -273,20 +319,216 @@ Effect<N>* LedWriter<N>::createEffectAbsolute(
                 return nullptr;
             }
         #endif
-        this->effects.push_back(new Effect<N>(
+        Effect<N>* created = new Effect<N>(
                 target, &this->channels, &this->now,
                 duration, recall, absoluteStart,
                 startVariation, durationVariation,
-                effectUID, loop
-            ));
-        this->effects.back()->verbose = this->verbose;
-        return this->effects.back();
+                effectUID, loop, easing, &this->random
+            );
+        created->mask = mask;
+        return enqueue(created);
     } else {
-        return updatedEffect;
+        return findEffect(effectUID);
     }
     print("Created effect");
 }
 
+template <unsigned int N>
+Effect<N>* LedWriter<N>::enqueue(Effect<N>* created) {
+    /* Takes ownership of a newly built effect. When scheduling is enabled,
+    effects starting in the future wait in the scheduler instead of
+    blocking the queue behind them. Channels owned by a track are
+    left to it. */
+    created->verbose = this->verbose;
+    created->mask &= this->mask;
+    if (this->scheduling && (static_cast<int32_t>(created->start - this->now) > 0)) {
+        this->scheduler->insert(created, this->now);
+    } else {
+        this->effects.push_back(created);
+    }
+    if (!this->uidIndex->insert(created) && this->verbose) {
+        // findEffect() scans for it until the queue drains
+        Serial.printf("Effect UID %u not indexed\n", created->uid);
+    }
+    this->revision++;
+    return created;
+}
+
+template <unsigned int N>
+uint32_t LedWriter<N>::createEffects(const EffectDescriptor<N>* descriptors, uint32_t count) {
+    /* Validates and queues a contiguous block of effects in one pass.
+    Nothing is queued unless every descriptor is valid and all fit;
+    returns the number of effects created. */
+    for (uint32_t i = 0; i < count; ++i) {
+        const EffectDescriptor<N>& descriptor = descriptors[i];
+        if (
+                !std::isfinite(descriptor.duration) || (descriptor.duration < 0)
+                || !std::isfinite(descriptor.start) || (descriptor.start < 0)
+                || (descriptor.start > 4294.967296)
+                || !std::isfinite(descriptor.hold) || (descriptor.hold < 0)
+            ) {
+            print("Invalid effect descriptor");
+            return 0;
+        }
+    }
+    #ifdef IS_EMBEDDED
+        if (
+                ((this->effects.size() + this->scheduler->pending() + count) > MAX_EFFECTS)
+                || (ESP.getFreeHeap() < (32768 + (count * sizeof(Effect<N>))))
+            ) {
+            print("Insufficient memory for effect creation");
+            return 0;
+        }
+    #endif
+    this->effects.reserve(this->effects.size() + count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const EffectDescriptor<N>& descriptor = descriptors[i];
+        Effect<N>* created = enqueue(new Effect<N>(
+                descriptor.target, &this->channels, &this->now,
+                (descriptor.duration ? descriptor.duration : this->globalEffectDuration),
+                false, this->now + static_cast<uint32_t>(descriptor.start * 1000000),
+                0, 0, descriptor.uid, descriptor.loop, descriptor.easing, &this->random
+            ));
+        if (descriptor.hold) {
+            created->hold(descriptor.hold, 1);
+        }
+    }
+    this->revision++;
+    print("Created effects");
+    return count;
+}
+
+template <unsigned int N>
+Timeline<N>* LedWriter<N>::createTimeline(
+        std::vector<Keyframe<N>> keyframes,
+        double relativeStart, uint32_t effectUID, int32_t loop
+    ) {
+    // Queues an entire keyframe sequence as a single effect
+    uint32_t absoluteStart;
+    if ((relativeStart > 0) && (relativeStart <= 4294.967296)) {
+        absoluteStart = this->now + static_cast<uint32_t>(relativeStart * 1000000);
+    } else {
+        absoluteStart = this->now;
+    }
+    return createTimelineAbsolute(std::move(keyframes), absoluteStart, effectUID, loop);
+}
+
+template <unsigned int N>
+Timeline<N>* LedWriter<N>::createTimelineAbsolute(
+        std::vector<Keyframe<N>> keyframes,
+        uint32_t absoluteStart, uint32_t effectUID, int32_t loop
+    ) {
+    #ifdef IS_EMBEDDED
+        if ((this->effects.size() >= MAX_EFFECTS) || (ESP.getFreeHeap() < 32768)) {
+            print("Insufficient memory for timeline creation");
+            return nullptr;
+        }
+    #endif
+    Timeline<N>* created = new Timeline<N>(
+            std::move(keyframes), &this->channels, &this->now,
+            absoluteStart, effectUID, loop
+        );
+    print("Created timeline");
+    return static_cast<Timeline<N>*>(enqueue(created));
+}
+
+template <unsigned int N>
+Generator<N>* LedWriter<N>::createGenerator(
+        std::array<Oscillator, N> oscillators,
+        double relativeStart, uint32_t effectUID
+    ) {
+    // Queues a periodic waveform that runs until skipped or cleared
+    uint32_t absoluteStart;
+    if ((relativeStart > 0) && (relativeStart <= 4294.967296)) {
+        absoluteStart = this->now + static_cast<uint32_t>(relativeStart * 1000000);
+    } else {
+        absoluteStart = this->now;
+    }
+    #ifdef IS_EMBEDDED
+        if ((this->effects.size() >= MAX_EFFECTS) || (ESP.getFreeHeap() < 32768)) {
+            print("Insufficient memory for generator creation");
+            return nullptr;
+        }
+    #endif
+    Generator<N>* created = new Generator<N>(
+            oscillators, &this->channels, &this->now, absoluteStart, effectUID
+        );
+    print("Created generator");
+    return static_cast<Generator<N>*>(enqueue(created));
+}
+
+template <unsigned int N>
+Effect<N>* LedWriter<N>::findEffect(uint32_t uid) {
+    /* An effect with uid in constant time; the rest follow via uidNext.
+    The index yields the newest match first and walks newest to oldest;
+    the fallback scan below walks queue order, then the scheduler. */
+    if (!this->uidIndex->overflowed) {
+        return this->uidIndex->find(uid);
+    }
+    // Index gave up; chain the matches by scanning the queue and scheduler
+    Effect<N>* head = nullptr;
+    Effect<N>* tail = nullptr;
+    auto link = [&](Effect<N>* candidate) {
+        if ((candidate == nullptr) || (candidate->uid != uid)) {
+            return;
+        }
+        candidate->uidPrevious = tail;
+        candidate->uidNext = nullptr;
+        if (tail != nullptr) {
+            tail->uidNext = candidate;
+        } else {
+            head = candidate;
+        }
+        tail = candidate;
+    };
+    for (auto& queued: this->effects) {
+        link(queued);
+    }
+    for (auto& entry: this->scheduler->heap) {
+        link(entry.effect);
+    }
+    return head;
+}
+
+template <unsigned int N>
+uint32_t LedWriter<N>::retimeEffects(
+        uint32_t uid, double duration, uint32_t absoluteStart
+    ) {
+    // Retimes every inactive effect with uid; returns how many were found
+    uint32_t count = 0;
+    duration = (duration ? duration : this->globalEffectDuration);
+    for (Effect<N>* effect = findEffect(uid); effect != nullptr; effect = effect->uidNext) {
+        effect->updateTimers(duration, absoluteStart);
+        this->scheduler->reschedule(effect, this->now);
+        count++;
+    }
+    this->revision++;
+    return count;
+}
+
+template <unsigned int N>
+uint32_t LedWriter<N>::cancelEffects(uint32_t uid) {
+    /* Cancels every effect with uid, including loops; cancelled effects
+    are discarded as they reach the front of the queue. */
+    uint32_t count = 0;
+    Effect<N>* next;
+    for (Effect<N>* effect = findEffect(uid); effect != nullptr; effect = next) {
+        next = effect->uidNext;
+        if (effect->scheduled >= 0) {
+            // Never reached the queue; discard outright
+            this->scheduler->remove(effect);
+            this->uidIndex->remove(effect);
+            delete effect;
+        } else {
+            effect->loop = 0;
+            effect->cancel();
+        }
+        count++;
+    }
+    this->revision++;
+    return count;
+}
+
 template <unsigned int N>
 void LedWriter<N>::alignEffects() {
     if (!effectsQueued()) {
@@ -303,6 +545,7 @@ void LedWriter<N>::alignEffects() {
         }
         last = effect->end;
     }
+    this->revision++;
 }
 
 template <unsigned int N>
@@ -318,6 +561,7 @@ void LedWriter<N>::overwrite(std::array<uint16_t, N> values) {
     for (int i = 0; i < N; ++i) {
         this->channels[i]->overwrite(values[i]);
     }
+    this->revision++;
     print("Overwritten");
 }
 
@@ -439,6 +683,20 @@ std::array<uint16_t, N> LedWriter<N>::getTarget() {
     return values;
 }
 
+template <unsigned int N>
+std::array<uint16_t, N> LedWriter<N>::evaluateAt(uint32_t time, bool* known) {
+    /* Predicted output of the queue at time on this writer's clock,
+    without stepping any live state. Tracks and layers are not included.
+    The index is rebuilt only after the queue has changed, and answers
+    from the clock at that rebuild up to 2^31 microseconds (~35 minutes)
+    later. Times outside that window clear known and return the output
+    at the rebuild rather than a prediction. */
+    if (!this->queueIndex->valid || (this->queueIndex->revision != this->revision)) {
+        this->queueIndex->build(this->effects, this->scheduler, this->channels, this->now, this->revision);
+    }
+    return this->queueIndex->evaluate(time, known);
+}
+
 template <unsigned int N>
 std::array<uint16_t, N> LedWriter<N>::getColorInversion(std::array<uint16_t, N> values) {
     std::array<uint16_t, N> inverted;
@@ -542,6 +800,11 @@ uint32_t LedWriter<N>::effectsQueued() {
     return (this->effects.size());
 }
 
+template <unsigned int N>
+uint32_t LedWriter<N>::effectsScheduled() {
+    return this->scheduler->pending();
+}
+
 template <unsigned int N>
 bool LedWriter<N>::effectsActive() {
     return (effectsQueued() ? this->effect->active : false);
@@ -567,6 +830,7 @@ int LedWriter<N>::looping() {
 template <unsigned int N>
 void LedWriter<N>::skipEffect() {
     this->effect->cancel();
+    this->revision++;
 }
 
 template <unsigned int N>
@@ -589,50 +853,32 @@ Effect<N>* LedWriter<N>::lastEffect() {
 }
 
 template <unsigned int N>
-void LedWriter<N>::cycleEffects() {
-    if (this->effect != nullptr) {
-        if (this->effect->complete() && !this->effect->active) {
-            this->lastUID = this->effect->uid;
-            this->lastCompletion = this->now;
-            if (this->globalSave->recallInquiry(this->effect->uid)) {
-                recall(true, true, true);
-            }
-            if (this->effect != nullptr) {
-                if (this->effect->loop != 0) {
-                    if (this->verbose) {
-                        Serial.printf("Looping effect UID %u", this->effect->uid);
-                    }
-                    this->effect->aborted = false;
-                    this->effect->last = this->now;
-                    this->effect->start = this->now;
-                    this->effect->uid = this->effects.back()->uid + 1;
-                    if (this->effect->loop > 0) {
-                        this->effect->loop--;
-                    }
-                    this->effects.push_back(this->effect);
-                } else {
-                    delete this->effect;
-                    this->effect = nullptr;
-                }
-            }
-            this->effects.erase(this->effects.begin());
-            this->effect = (effectsQueued() ? this->effects.front() : nullptr);
-        } else {
-            if (this->effect->run()) {
-                if (this->globalSave->saveInquiry(this->effect->uid)) {
-                    save(true);
-                }
-            }
+void LedWriter<N>::notify(uint8_t type, Effect<N>* effect) {
+    // Base queue progress from EffectQueue::cycleEffects()
+    if (type & (EffectEvent<N>::LOOPED | EffectEvent<N>::COMPLETED)) {
+        this->lastUID = effect->uid;
+        this->lastCompletion = this->now;
+        if (this->verbose && (type == EffectEvent<N>::LOOPED)) {
+            Serial.printf("Looping effect UID %u", effect->uid);
+        }
+    } else if (type == EffectEvent<N>::DRAINED) {
+        if (this->scheduler->pending()) {
+            return;
         }
-    } else if (effectsQueued() && (this->effect == nullptr)) {
-        print("Setting effect");
-        this->effect = this->effects.front();
+        this->uidIndex->reset();
     }
+    emit(type, effect);
 }
 
 template <unsigned int N>
 void LedWriter<N>::clearEffects(bool cancel) {
     print("Clearing effects");
+    while (this->scheduler->pending()) {
+        Effect<N>* pending = this->scheduler->heap.back().effect;
+        this->scheduler->remove(pending);
+        this->uidIndex->remove(pending);
+        delete pending;
+    }
     if (effectsQueued()) {
         int end = cancel ? 0 : 1;
         for (int i = this->effects.size() - 1; i >= end; --i) {
@@ -640,6 +886,7 @@ void LedWriter<N>::clearEffects(bool cancel) {
                 Serial.printf("\tClearing effect UID %d\n", this->effects[i]->uid);
             }
             if (this->effects[i] != nullptr) {
+                this->uidIndex->remove(this->effects[i]);
                 delete this->effects[i];
             }
             this->effects.erase(this->effects.begin() + i);
@@ -651,9 +898,143 @@ void LedWriter<N>::clearEffects(bool cancel) {
             this->effects.shrink_to_fit();
         }
     }
+    if (!effectsQueued()) {
+        this->uidIndex->reset();
+    }
+    this->revision++;
     print("Effects cleared");
 }
 
+template <unsigned int N>
+bool LedWriter<N>::listen(Listener listener, void* context, uint8_t events) {
+    /* Registers a function called from run() as effects on the base
+    queue change state; context is passed back untouched. Fixed storage,
+    so returns false once MAX_LISTENERS are registered. */
+    for (uint8_t i = 0; i < this->listenerCount; ++i) {
+        if ((this->listeners[i].listener == listener) && (this->listeners[i].context == context)) {
+            this->listeners[i].events = events;
+            return true;
+        }
+    }
+    if (this->listenerCount >= MAX_LISTENERS) {
+        print("Too many listeners");
+        return false;
+    }
+    this->listeners[this->listenerCount++] = {listener, context, events};
+    return true;
+}
+
+template <unsigned int N>
+bool LedWriter<N>::unlisten(Listener listener, void* context) {
+    for (uint8_t i = 0; i < this->listenerCount; ++i) {
+        if ((this->listeners[i].listener == listener) && (this->listeners[i].context == context)) {
+            // Shift down so listeners keep registration order
+            for (uint8_t j = i + 1; j < this->listenerCount; ++j) {
+                this->listeners[j - 1] = this->listeners[j];
+            }
+            this->listenerCount--;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <unsigned int N>
+void LedWriter<N>::emit(uint8_t type, Effect<N>* effect) {
+    // Calls each listener for the event in registration order
+    EffectEvent<N> event = {
+            type, ((effect != nullptr) ? effect->uid : 0), this->now, effect, this
+        };
+    for (uint8_t i = 0; i < this->listenerCount; ++i) {
+        if (this->listeners[i].events & type) {
+            this->listeners[i].listener(event, this->listeners[i].context);
+            if (event.effect != this->effect) {
+                event.effect = nullptr;
+            }
+        }
+    }
+}
+
+template <unsigned int N>
+EffectQueue<N>* LedWriter<N>::createTrack(uint32_t mask) {
+    /* Adds an independent effect queue driving only the masked channels
+    (bit 0 is channel 0). Tracks advance in the same tick as the base queue,
+    so effects on unrelated channels run concurrently. */
+    EffectQueue<N>* created = new EffectQueue<N>(&this->channels, &this->now, mask, MAX_LAYER_EFFECTS);
+    created->verbose = this->verbose;
+    this->tracks.push_back(created);
+    // Base effects give up the track's channels, or they would wait on targets the track overrides
+    this->mask &= ~mask;
+    for (auto queued: this->effects) {
+        queued->mask &= this->mask;
+    }
+    for (auto& entry: this->scheduler->heap) {
+        entry.effect->mask &= this->mask;
+    }
+    this->revision++;
+    print("Created track");
+    return created;
+}
+
+template <unsigned int N>
+void LedWriter<N>::removeTrack(EffectQueue<N>* track) {
+    auto found = std::find(this->tracks.begin(), this->tracks.end(), track);
+    if (found != this->tracks.end()) {
+        delete track;
+        this->tracks.erase(found);
+        // Effects queued from here on drive the freed channels again
+        this->mask = 0xFFFFFFFF;
+        for (auto remaining: this->tracks) {
+            this->mask &= ~remaining->mask;
+        }
+        print("Removed track");
+    }
+}
+
+template <unsigned int N>
+Layer<N>* LedWriter<N>::createLayer(uint8_t blend, double opacity) {
+    /* Adds a layer with its own effect queue, composited above
+    the base effects and any previously created layers. */
+    Layer<N>* created = new Layer<N>(this->resolution, &this->now, blend, opacity);
+    created->verbose = this->verbose;
+    this->layers.push_back(created);
+    for (auto channel: this->channels) {
+        // Base effects stop writing directly; composite() writes instead
+        channel->muted = true;
+    }
+    print("Created layer");
+    return created;
+}
+
+template <unsigned int N>
+void LedWriter<N>::removeLayer(Layer<N>* layer) {
+    auto found = std::find(this->layers.begin(), this->layers.end(), layer);
+    if (found == this->layers.end()) {
+        return;
+    }
+    delete layer;
+    this->layers.erase(found);
+    if (this->layers.empty()) {
+        for (auto channel: this->channels) {
+            channel->muted = false;
+        }
+        write();
+    }
+    print("Removed layer");
+}
+
+template <unsigned int N>
+void LedWriter<N>::composite() {
+    // Blends all layers over the base channels and writes the result
+    for (int i = 0; i < N; ++i) {
+        uint16_t value = this->channels[i]->value;
+        for (auto layer: this->layers) {
+            value = layer->composite(i, value);
+        }
+        this->channels[i]->output(this->channels[i]->conform(value));
+    }
+}
+
 template <unsigned int N>
 void LedWriter<N>::hold(double seconds, double timeIndex, bool all) {
     /* Holds active effect when fade is completed.
@@ -666,6 +1047,7 @@ void LedWriter<N>::hold(double seconds, double timeIndex, bool all) {
                 this->effects[i]->hold(seconds, timeIndex);
             }
         }
+        this->revision++;
     }
 }
 
@@ -676,6 +1058,7 @@ void LedWriter<N>::holdLast(double seconds, double timeIndex) {
     if (effectsQueued()) {
         print("Setting hold on last queued effect");
         this->effects.back()->hold(seconds, timeIndex);
+        this->revision++;
     }
 }
 
@@ -684,6 +1067,7 @@ void LedWriter<N>::resume() {
     // Resumes effect if one is active
     if (effectsQueued()) {
         this->effect->resume();
+        this->revision++;
     }
 }
 
@@ -844,7 +1228,49 @@ void LedWriter<N>::run() {
         must be processed here as a time-based effect.
     */
     updateClock();
+    advance();
+}
+
+template <unsigned int N>
+void LedWriter<N>::run(uint32_t currentTime) {
+    /* Processes effects against an externally supplied clock, e.g. a
+    virtual timeline on a host, instead of reading micros(). */
+    this->now = currentTime;
+    advance();
+}
+
+template <unsigned int N>
+void LedWriter<N>::advance() {
+    /* One engine tick at the current value of now. Scheduled effects
+    start when due: each goes ahead of anything still waiting, and cuts
+    short a running effect, loops and all, rather than queue behind it. */
+    size_t position = 0;
+    for (Effect<N>* due; (due = this->scheduler->expire(this->now)) != nullptr;) {
+        if (!position && (this->effect != nullptr)) {
+            if (this->effect->active || this->effect->complete()) {
+                // The front effect has run; it stays ahead to be cycled off
+                position = 1;
+                if (!this->effect->complete()) {
+                    this->effect->loop = 0;
+                    this->effect->cancel();
+                }
+            } else {
+                this->effect = nullptr;
+            }
+        }
+        this->effects.insert(this->effects.begin() + position++, due);
+        this->revision++;
+    }
     cycleEffects();
+    for (auto track: this->tracks) {
+        track->cycleEffects();
+    }
+    if (!this->layers.empty()) {
+        for (auto layer: this->layers) {
+            layer->cycleEffects();
+        }
+        composite();
+    }
 }
 
 template <int N=3>
@@ -865,13 +1291,13 @@ template <unsigned int N>
 void LedWriter<N>::startTasks() {
     print("Starting run task");
     #if ESP32
-        xTaskCreatePinnedToCore(loop, "runner", 40000, this, 1, NULL, 1);
+        xTaskCreatePinnedToCore(loop<N>, "runner", 40000, this, 1, NULL, 1);
     #elif ESP8266
-        xTaskCreate(loop, "runner", 40000, this, 1, NULL);
+        xTaskCreate(loop<N>, "runner", 40000, this, 1, NULL);
     #elif __AVR__
         return;
     #else
-        std::thread(loop);
+        std::thread(loop<N>, this).detach();
     #endif
     print("Run task started");
 }
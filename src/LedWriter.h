@@ -30,14 +30,34 @@
 #include <thread>
 #include <vector>
 #include "Effect.h"
+#include "Timeline.h"
+#include "Generator.h"
+#include "EffectQueue.h"
+#include "UidIndex.h"
+#include "Scheduler.h"
+#include "QueueIndex.h"
 
 #if !IS_EMBEDDED
     #include <chrono>
 #endif
 
 #define MAX_EFFECTS     1000
+#define EFFECTS_RESERVE 16 // Queue storage up front; grows on demand to MAX_EFFECTS
+#define LEDC_CHANNELS   16
+#define MAX_LISTENERS   8
 #define USE_TASKS       false
 
+template <unsigned int N=4>
+struct EffectDescriptor {
+    std::array<uint16_t, N> target;
+    double duration = 0; // Seconds; global effect duration if 0
+    double start = 0; // Seconds from now
+    double hold = 0; // Seconds to hold target after the fade
+    uint32_t uid = 0;
+    int32_t loop = 0;
+    const Easing* easing = nullptr;
+};
+
 template <unsigned int N=4>
 class GlobalSave {
     public:
@@ -50,26 +70,45 @@ class GlobalSave {
         std::array<uint16_t, N> recall();
         bool recallInquiry(uint32_t);
         bool saveInquiry(uint32_t);
+        static void react(const EffectEvent<N>& event, void* context);
 };
 
 template <unsigned int N=4>
-class LedWriter : public SimpleSerialBase {
+class LedWriter : public EffectQueue<N> {
+    /* Drives N hardware channels from its base effect queue, plus any
+    tracks and layers, and reports queue events to listeners. */
     public:
+        using EffectQueue<N>::print;
+        using EffectQueue<N>::cycleEffects;
+        typedef void (*Listener)(const EffectEvent<N>& event, void* context);
+        struct Subscription {
+            Listener listener;
+            void* context;
+            uint8_t events;
+        };
         std::array<ColorChannel*, N> channels;
         std::array<uint16_t*, N> color;
         GlobalSave<N>* globalSave;
-        std::vector<Effect<N>*> effects;
-        Effect<N>* effect = nullptr;
-        bool inverted = false, verbose = false;
+        Scheduler<N>* scheduler;
+        QueueIndex<N>* queueIndex; // Rebuilt on demand when revision moves on
+        std::vector<EffectQueue<N>*> tracks;
+        std::vector<Layer<N>*> layers;
+        Random random; // Seed for reproducible start and duration variation
+        std::array<Subscription, MAX_LISTENERS> listeners;
+        uint8_t listenerCount = 0;
+        bool
+            inverted = false, verbose = false,
+            scheduling = false; // Hold future-dated effects out of the queue until due
         double frequency, globalEffectDuration = 1e-6;
         uint8_t resolution;
         uint16_t absoluteMaximum, maximum, minimum = 0;
         uint32_t timeIndex = 0, now = 0, lastUID = 0, lastCompletion = 0;
-        LedWriter(std::array<uint8_t, N>, uint8_t=10, bool=true);
+        LedWriter(std::array<uint8_t, N>, uint8_t=10, bool=true, uint8_t firstChannel=0);
         LedWriter(uint8_t=10, bool=true);
-        void init(std::array<uint8_t, N>, uint8_t=10, bool=true);
+        void init(std::array<uint8_t, N>, uint8_t=10, bool=true, uint8_t firstChannel=0);
         ~LedWriter();
         void setPolarityInversion(bool);
+        void seed(uint64_t);
         void setScale(std::array<double, N>);
         void setOffset(std::array<int16_t, N>);
         void setMax(uint16_t);
@@ -83,14 +122,33 @@ class LedWriter : public SimpleSerialBase {
                 std::array<uint16_t, N> target,
                 double duration=0, bool recall=false, double relativeStart=0,
                 double startVariation=0, double durationVariation=0,
-                uint32_t effectUID=0, bool updateUID=false, int32_t loop=0
+                uint32_t effectUID=0, bool updateUID=false, int32_t loop=0,
+                const Easing* easing=nullptr, uint32_t mask=0xFFFFFFFF
             );
         Effect<N>* createEffectAbsolute(
                 std::array<uint16_t, N> target,
                 double duration=0, bool recall=false, uint32_t absoluteStart=0,
                 double startVariation=0, double durationVariation=0,
-                uint32_t effectUID=0, bool updateUID=false, int32_t loop=0
+                uint32_t effectUID=0, bool updateUID=false, int32_t loop=0,
+                const Easing* easing=nullptr, uint32_t mask=0xFFFFFFFF
+            );
+        Effect<N>* enqueue(Effect<N>*);
+        uint32_t createEffects(const EffectDescriptor<N>* descriptors, uint32_t count);
+        Timeline<N>* createTimeline(
+                std::vector<Keyframe<N>> keyframes,
+                double relativeStart=0, uint32_t effectUID=0, int32_t loop=0
+            );
+        Timeline<N>* createTimelineAbsolute(
+                std::vector<Keyframe<N>> keyframes,
+                uint32_t absoluteStart, uint32_t effectUID=0, int32_t loop=0
             );
+        Generator<N>* createGenerator(
+                std::array<Oscillator, N> oscillators,
+                double relativeStart=0, uint32_t effectUID=0
+            );
+        Effect<N>* findEffect(uint32_t uid);
+        uint32_t retimeEffects(uint32_t uid, double duration, uint32_t absoluteStart);
+        uint32_t cancelEffects(uint32_t uid);
         void alignEffects();
         void write();
         void overwrite(std::array<uint16_t, N>);
@@ -102,6 +160,7 @@ class LedWriter : public SimpleSerialBase {
         std::array<uint16_t, N> secondary(uint8_t, uint16_t value=0);
         std::array<uint16_t, N> getCurrent();
         std::array<uint16_t, N> getTarget();
+        std::array<uint16_t, N> evaluateAt(uint32_t time, bool* known=nullptr);
         std::array<uint16_t, N> getColorInversion(std::array<uint16_t, N>);
         std::array<uint16_t, N> getColorInversion();
         bool illuminated();
@@ -113,14 +172,23 @@ class LedWriter : public SimpleSerialBase {
         void updateTimers(uint32_t delta);
         bool updateClock(uint32_t* currentTime=nullptr, bool adjust=false);
         uint32_t effectsQueued();
+        uint32_t effectsScheduled();
         bool effectsActive();
         int looping();
         void skipEffect();
         void updateEffects(std::array<uint16_t, N>);
         Effect<N>* nextEffect();
         Effect<N>* lastEffect();
-        void cycleEffects();
         void clearEffects(bool cancel=true);
+        bool listen(Listener listener, void* context=nullptr, uint8_t events=EffectEvent<N>::ALL);
+        bool unlisten(Listener listener, void* context=nullptr);
+        void emit(uint8_t type, Effect<N>* effect=nullptr);
+        void notify(uint8_t type, Effect<N>* effect) override;
+        EffectQueue<N>* createTrack(uint32_t mask);
+        void removeTrack(EffectQueue<N>*);
+        Layer<N>* createLayer(uint8_t blend=Layer<N>::REPLACE, double opacity=1);
+        void removeLayer(Layer<N>*);
+        void composite();
         void hold(double=0.5, double timeIndex=1, bool all=false);
         void holdLast(double=0.5, double timeIndex=1);
         void resume();
@@ -135,12 +203,12 @@ class LedWriter : public SimpleSerialBase {
         void test(double duration=1.5);
         void status();
         void run();
+        void run(uint32_t currentTime);
+        void advance();
         friend void loop();
         void startTasks();
 };
 
-#endif
-
 template class GlobalSave<1>;
 template class GlobalSave<2>;
 template class GlobalSave<3>;
@@ -152,3 +220,5 @@ template class LedWriter<2>;
 template class LedWriter<3>;
 template class LedWriter<4>;
 template class LedWriter<5>;
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "OfflineRenderer.h"
+
+#ifndef IS_EMBEDDED
+
+#include <thread>
+
+template <unsigned int N>
+OfflineRenderer<N>::OfflineRenderer(
+        uint32_t frameCount, double rate, uint32_t tick, unsigned int workers
+    ) {
+    this->frameCount = frameCount;
+    this->interval = ((rate > 0) ? static_cast<uint32_t>(1e6 / rate) : 10000);
+    this->tick = (tick ? tick : 1);
+    this->workers = (workers ? workers : std::thread::hardware_concurrency());
+    if (!this->workers) {
+        this->workers = 1;
+    }
+}
+
+template <unsigned int N>
+uint32_t OfflineRenderer<N>::add(LedWriter<N>* writer, ShowPlayer<N>* player) {
+    // Output is allocated up front so workers never touch the allocator
+    Fixture<N> fixture;
+    fixture.writer = writer;
+    fixture.player = player;
+    fixture.frames.resize(static_cast<size_t>(this->frameCount) * N);
+    this->fixtures.push_back(std::move(fixture));
+    return (this->fixtures.size() - 1);
+}
+
+template <unsigned int N>
+const uint16_t* OfflineRenderer<N>::frame(uint32_t fixture, uint32_t index) {
+    if ((fixture >= this->fixtures.size()) || (index >= this->frameCount)) {
+        return nullptr;
+    }
+    return &this->fixtures[fixture].frames[static_cast<size_t>(index) * N];
+}
+
+template <unsigned int N>
+void OfflineRenderer<N>::render() {
+    uint32_t count = this->fixtures.size();
+    unsigned int threads = ((this->workers < count) ? this->workers : count);
+    if (!threads) {
+        return;
+    }
+    // Split fixtures into one contiguous share per worker
+    std::vector<Share> shares(threads);
+    for (unsigned int i = 0; i < threads; ++i) {
+        shares[i].next.store((static_cast<uint64_t>(count) * i) / threads, std::memory_order_relaxed);
+        shares[i].end = ((static_cast<uint64_t>(count) * (i + 1)) / threads);
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned int i = 1; i < threads; ++i) {
+        pool.emplace_back(&OfflineRenderer<N>::work, this, std::ref(shares), i);
+    }
+    work(shares, 0);
+    for (auto& thread: pool) {
+        thread.join();
+    }
+}
+
+template <unsigned int N>
+bool OfflineRenderer<N>::claim(Share& share, uint32_t& fixture) {
+    // Cheap early out; fetch_add may still overshoot, which is harmless
+    if (share.next.load(std::memory_order_relaxed) >= share.end) {
+        return false;
+    }
+    fixture = share.next.fetch_add(1, std::memory_order_relaxed);
+    return (fixture < share.end);
+}
+
+template <unsigned int N>
+void OfflineRenderer<N>::work(std::vector<Share>& shares, unsigned int worker) {
+    unsigned int threads = shares.size();
+    uint32_t fixture;
+    while (claim(shares[worker], fixture)) {
+        renderFixture(this->fixtures[fixture]);
+    }
+    // Own share done; steal from the others, nearest first
+    for (unsigned int offset = 1; offset < threads; ++offset) {
+        Share& victim = shares[(worker + offset) % threads];
+        while (claim(victim, fixture)) {
+            renderFixture(this->fixtures[fixture]);
+        }
+    }
+}
+
+template <unsigned int N>
+void OfflineRenderer<N>::renderFixture(Fixture<N>& fixture) {
+    LedWriter<N>* writer = fixture.writer;
+    uint16_t* output = fixture.frames.data();
+    uint64_t time = 0, nextFrame = 0;
+    uint32_t rendered = 0;
+    writer->run(0);
+    if (fixture.player != nullptr) {
+        fixture.player->play();
+    }
+    while (rendered < this->frameCount) {
+        if (fixture.player != nullptr) {
+            fixture.player->run();
+        }
+        writer->run(static_cast<uint32_t>(time));
+        while ((nextFrame <= time) && (rendered < this->frameCount)) {
+            for (unsigned int i = 0; i < N; ++i) {
+                *output++ = writer->channels[i]->written;
+            }
+            nextFrame += this->interval;
+            ++rendered;
+        }
+        time += this->tick;
+    }
+}
+
+#endif
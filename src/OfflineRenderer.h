@@ -0,0 +1,79 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include <stdint.h>
+#include <vector>
+#include "LedWriter.h"
+#include "ShowFile.h"
+
+#ifndef IS_EMBEDDED
+
+#include <atomic>
+
+template <unsigned int N=3>
+struct Fixture {
+    LedWriter<N>* writer;
+    ShowPlayer<N>* player; // Optional; tops up the writer's queue per tick
+    std::vector<uint16_t> frames; // N values per frame, preallocated
+};
+
+template <unsigned int N=3>
+class OfflineRenderer {
+    /* Renders many independent fixtures on a virtual timeline across a
+    pool of threads. Each worker claims whole fixtures from its own
+    contiguous share and steals from the others once its share is
+    exhausted, so uneven shows still keep every core busy. */
+    public:
+        std::vector<Fixture<N>> fixtures;
+        uint32_t frameCount, interval, tick;
+        unsigned int workers;
+        OfflineRenderer(
+                uint32_t frameCount, double rate=100,
+                uint32_t tick=1000, unsigned int workers=0
+            );
+        uint32_t add(LedWriter<N>* writer, ShowPlayer<N>* player=nullptr);
+        void render();
+        const uint16_t* frame(uint32_t fixture, uint32_t index);
+    protected:
+        struct alignas(64) Share {
+            std::atomic<uint32_t> next;
+            uint32_t end;
+        };
+        void work(std::vector<Share>& shares, unsigned int worker);
+        bool claim(Share& share, uint32_t& fixture);
+        void renderFixture(Fixture<N>& fixture);
+};
+
+template class OfflineRenderer<1>;
+template class OfflineRenderer<2>;
+template class OfflineRenderer<3>;
+template class OfflineRenderer<4>;
+template class OfflineRenderer<5>;
+
+#endif
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "PixelMap.h"
+#include <cmath>
+
+Palette::Palette(std::vector<std::array<uint8_t, 4>> stops) {
+    // Stops are spread evenly from level 0 to 65535
+    if (stops.empty()) {
+        stops.push_back({0, 0, 0, 0});
+    }
+    uint32_t segments = (stops.size() - 1);
+    for (uint32_t i = 0; i < 256; ++i) {
+        if (!segments) {
+            this->colors[i] = stops[0];
+            continue;
+        }
+        uint32_t scaled = (i * segments * 256 / 255);
+        uint32_t stop = std::min(scaled >> 8, segments - 1);
+        int32_t fraction = (scaled - (stop << 8));
+        for (int c = 0; c < 4; ++c) {
+            int32_t from = stops[stop][c], to = stops[stop + 1][c];
+            this->colors[i][c] = (from + (((to - from) * fraction) / 256));
+        }
+    }
+}
+
+const std::array<uint8_t, 4>& Palette::lookup(uint16_t level) const {
+    return this->colors[level >> 8];
+}
+
+PixelMap::PixelMap(uint32_t reserve) {
+    this->x.reserve(reserve);
+    this->y.reserve(reserve);
+}
+
+uint32_t PixelMap::add(float x, float y) {
+    this->x.push_back(x);
+    this->y.push_back(y);
+    this->phases.resize(this->x.size());
+    this->levels.resize(this->x.size());
+    return (this->x.size() - 1);
+}
+
+uint32_t PixelMap::addLine(uint32_t count, float x0, float y0, float x1, float y1) {
+    // Evenly spaced points from (x0, y0) to (x1, y1); returns the first index
+    uint32_t first = this->x.size();
+    for (uint32_t i = 0; i < count; ++i) {
+        float t = ((count > 1) ? (static_cast<float>(i) / (count - 1)) : 0);
+        add((x0 + ((x1 - x0) * t)), (y0 + ((y1 - y0) * t)));
+    }
+    return first;
+}
+
+uint32_t PixelMap::addGrid(uint32_t columns, uint32_t rows, bool serpentine) {
+    /* Row-major grid over the unit square; serpentine reverses every
+    other row to match matrices wired back and forth. */
+    uint32_t first = this->x.size();
+    for (uint32_t row = 0; row < rows; ++row) {
+        float y = ((rows > 1) ? (static_cast<float>(row) / (rows - 1)) : 0);
+        for (uint32_t column = 0; column < columns; ++column) {
+            uint32_t placed = ((serpentine && (row & 1)) ? (columns - 1 - column) : column);
+            add(((columns > 1) ? (static_cast<float>(placed) / (columns - 1)) : 0), y);
+        }
+    }
+    return first;
+}
+
+uint32_t PixelMap::size() {
+    return this->x.size();
+}
+
+void PixelMap::normalize() {
+    // Fits the points into the unit square, keeping their aspect ratio
+    if (this->x.empty()) {
+        return;
+    }
+    auto xRange = std::minmax_element(this->x.begin(), this->x.end());
+    auto yRange = std::minmax_element(this->y.begin(), this->y.end());
+    float xMin = *xRange.first, yMin = *yRange.first;
+    float span = std::max((*xRange.second - xMin), (*yRange.second - yMin));
+    float factor = ((span > 0) ? (1 / span) : 1);
+    for (uint32_t i = 0; i < this->x.size(); ++i) {
+        this->x[i] = ((this->x[i] - xMin) * factor);
+        this->y[i] = ((this->y[i] - yMin) * factor);
+    }
+}
+
+void PixelMap::project(float dx, float dy, float cycles) {
+    // Position along a direction, in 1/65535 cycle units, plus time offset
+    float factor = (this->pattern.scale * 65535);
+    uint32_t shift = static_cast<uint32_t>(static_cast<int64_t>(cycles * 65536));
+    const float* xs = this->x.data();
+    const float* ys = this->y.data();
+    uint32_t* phases = this->phases.data();
+    uint32_t count = this->x.size();
+    for (uint32_t i = 0; i < count; ++i) {
+        phases[i] = (static_cast<uint32_t>(static_cast<int32_t>(((xs[i] * dx) + (ys[i] * dy)) * factor)) + shift);
+    }
+}
+
+void PixelMap::distance(float cycles) {
+    float factor = (this->pattern.scale * 65535);
+    float cx = this->pattern.centerX, cy = this->pattern.centerY;
+    uint32_t shift = static_cast<uint32_t>(static_cast<int64_t>(cycles * 65536));
+    const float* xs = this->x.data();
+    const float* ys = this->y.data();
+    uint32_t* phases = this->phases.data();
+    uint32_t count = this->x.size();
+    for (uint32_t i = 0; i < count; ++i) {
+        float ox = (xs[i] - cx), oy = (ys[i] - cy);
+        phases[i] = (static_cast<uint32_t>(static_cast<int32_t>(std::sqrt((ox * ox) + (oy * oy)) * factor)) + shift);
+    }
+}
+
+void PixelMap::shapeSine() {
+    uint32_t count = this->x.size();
+    for (uint32_t i = 0; i < count; ++i) {
+        this->levels[i] = Generator<1>::sine(this->phases[i]);
+    }
+}
+
+void PixelMap::evaluate(uint32_t time) {
+    /* Fills levels for every point at time (microseconds). Patterns
+    move by speed cycles per second; gradients and waves travel along
+    angle, radial gradients outward from the center. */
+    const Pattern& pattern = this->pattern;
+    uint32_t count = this->x.size();
+    double elapsed = (pattern.speed * (time * 1e-6));
+    float cycles = static_cast<float>((elapsed - std::floor(elapsed)) + pattern.phase);
+    float dx = std::cos(pattern.angle), dy = std::sin(pattern.angle);
+    switch (pattern.type) {
+        case LINEAR_GRADIENT:
+            project(dx, dy, -cycles);
+            for (uint32_t i = 0; i < count; ++i) {
+                this->levels[i] = this->phases[i];
+            }
+            break;
+        case RADIAL_GRADIENT:
+            distance(-cycles);
+            for (uint32_t i = 0; i < count; ++i) {
+                this->levels[i] = this->phases[i];
+            }
+            break;
+        case WAVE:
+            project(dx, dy, -cycles);
+            shapeSine();
+            break;
+        case PLASMA:
+            // Mean of two crossing waves and a ring, each a third of range
+            project(1, 0, cycles);
+            for (uint32_t i = 0; i < count; ++i) {
+                this->levels[i] = (Generator<1>::sine(this->phases[i]) / 3);
+            }
+            project(.5f, .866f, (cycles * 1.3f));
+            for (uint32_t i = 0; i < count; ++i) {
+                this->levels[i] += (Generator<1>::sine(this->phases[i]) / 3);
+            }
+            distance(-(cycles * .7f));
+            for (uint32_t i = 0; i < count; ++i) {
+                this->levels[i] += (Generator<1>::sine(this->phases[i]) / 3);
+            }
+            break;
+        case IMAGE: {
+            // Nearest sample, tiled; scrolls along angle
+            if ((pattern.image == nullptr) || !pattern.imageWidth || !pattern.imageHeight) {
+                std::fill(this->levels.begin(), this->levels.end(), 0);
+                break;
+            }
+            float scrollX = (dx * cycles), scrollY = (dy * cycles);
+            for (uint32_t i = 0; i < count; ++i) {
+                float u = ((this->x[i] * pattern.scale) - scrollX);
+                float v = ((this->y[i] * pattern.scale) - scrollY);
+                u -= std::floor(u);
+                v -= std::floor(v);
+                uint32_t column = std::min<uint32_t>((u * pattern.imageWidth), (pattern.imageWidth - 1));
+                uint32_t row = std::min<uint32_t>((v * pattern.imageHeight), (pattern.imageHeight - 1));
+                this->levels[i] = (pattern.image[(row * pattern.imageWidth) + column] * 257);
+            }
+            break;
+        }
+        default:
+            print("Unknown pattern");
+            break;
+    }
+}
+
+void PixelMap::render(PixelStrip& strip, const Palette& palette, uint32_t offset) {
+    // Point i lands on pixel offset + i
+    uint32_t count = this->x.size();
+    for (uint32_t i = 0; (i < count) && ((offset + i) < strip.pixels); ++i) {
+        strip.set((offset + i), palette.lookup(this->levels[i]));
+    }
+}
+
+template <unsigned int N>
+void PixelMap::render(
+        LedWriter<N>* const* fixtures, uint32_t count,
+        std::array<uint16_t, N> low, std::array<uint16_t, N> high
+    ) {
+    /* Point i drives fixture i, blending each channel between low and
+    high by the point's level. Writes bypass the fixture's queue. */
+    count = std::min<uint32_t>(count, this->x.size());
+    for (uint32_t i = 0; i < count; ++i) {
+        int64_t level = this->levels[i];
+        for (unsigned int c = 0; c < N; ++c) {
+            int32_t from = low[c], to = high[c];
+            fixtures[i]->channels[c]->overwrite(from + (((to - from) * level) / 65535));
+        }
+    }
+}
+
+template void PixelMap::render<1>(LedWriter<1>* const*, uint32_t, std::array<uint16_t, 1>, std::array<uint16_t, 1>);
+template void PixelMap::render<2>(LedWriter<2>* const*, uint32_t, std::array<uint16_t, 2>, std::array<uint16_t, 2>);
+template void PixelMap::render<3>(LedWriter<3>* const*, uint32_t, std::array<uint16_t, 3>, std::array<uint16_t, 3>);
+template void PixelMap::render<4>(LedWriter<4>* const*, uint32_t, std::array<uint16_t, 4>, std::array<uint16_t, 4>);
+template void PixelMap::render<5>(LedWriter<5>* const*, uint32_t, std::array<uint16_t, 5>, std::array<uint16_t, 5>);
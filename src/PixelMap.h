@@ -0,0 +1,83 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef PIXELMAP_H
+#define PIXELMAP_H
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include "LedWriter.h"
+#include "PixelStrip.h"
+
+struct Pattern {
+    uint8_t type = 0; // PixelMap::Shape
+    float angle = 0; // Radians; direction of travel for gradients and waves
+    float centerX = .5, centerY = .5; // Radial gradients and plasma
+    float scale = 1; // Repeats across the unit square
+    float speed = 0; // Cycles per second
+    float phase = 0; // Cycles
+    const uint8_t* image = nullptr; // Row-major levels, one byte per pixel
+    uint16_t imageWidth = 0, imageHeight = 0;
+};
+
+class Palette {
+    // Maps a 0 - 65535 level to a color through 256 precomputed entries
+    public:
+        std::array<std::array<uint8_t, 4>, 256> colors;
+        Palette(std::vector<std::array<uint8_t, 4>> stops={{0, 0, 0, 0}, {255, 255, 255, 0}});
+        const std::array<uint8_t, 4>& lookup(uint16_t level) const;
+};
+
+class PixelMap : public SimpleSerialBase {
+    /* Places outputs on a plane and fills a level for every point from
+    one spatial pattern per frame, so a single pattern drives any number
+    of strip pixels or fixtures. Coordinates are stored as separate x and
+    y arrays, and each frame is a few flat passes over them. */
+    public:
+        enum Shape : uint8_t {LINEAR_GRADIENT, RADIAL_GRADIENT, WAVE, PLASMA, IMAGE};
+        std::vector<float> x, y;
+        std::vector<uint32_t> phases; // Scratch; one cycle is 65536
+        std::vector<uint16_t> levels;
+        Pattern pattern;
+        PixelMap(uint32_t reserve=0);
+        uint32_t add(float x, float y);
+        uint32_t addLine(uint32_t count, float x0, float y0, float x1, float y1);
+        uint32_t addGrid(uint32_t columns, uint32_t rows, bool serpentine=false);
+        uint32_t size();
+        void normalize();
+        void evaluate(uint32_t time);
+        void render(PixelStrip& strip, const Palette& palette, uint32_t offset=0);
+        template <unsigned int N>
+        void render(
+                LedWriter<N>* const* fixtures, uint32_t count,
+                std::array<uint16_t, N> low, std::array<uint16_t, N> high
+            );
+    protected:
+        void project(float dx, float dy, float cycles);
+        void distance(float cycles);
+        void shapeSine();
+};
+
+#endif
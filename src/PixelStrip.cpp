@@ -0,0 +1,258 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "PixelStrip.h"
+
+#if ESP32
+    #include <SPI.h>
+#endif
+
+void MemorySink::write(const uint8_t* data, size_t length) {
+    this->data.assign(data, data + length);
+    this->frames++;
+}
+
+#if ESP32
+SpiSink::SpiSink(int8_t pin, uint32_t frequency) {
+    this->frequency = frequency;
+    SPI.begin(-1, -1, pin, -1);
+}
+
+void SpiSink::write(const uint8_t* data, size_t length) {
+    SPI.beginTransaction(SPISettings(this->frequency, MSBFIRST, SPI_MODE0));
+    SPI.writeBytes(data, length);
+    SPI.endTransaction();
+}
+#endif
+
+uint32_t Ws2812Encoder::expand(uint8_t value) {
+    uint32_t pattern = 0;
+    for (int bit = 7; bit >= 0; --bit) {
+        pattern = ((pattern << 3) | ((value >> bit) & 1 ? 0b110 : 0b100));
+    }
+    return pattern;
+}
+
+const std::array<uint32_t, 256>& Ws2812Encoder::table() {
+    static const std::array<uint32_t, 256> patterns = []() {
+        std::array<uint32_t, 256> generated;
+        for (int i = 0; i < 256; ++i) {
+            generated[i] = expand(i);
+        }
+        return generated;
+    }();
+    return patterns;
+}
+
+const uint8_t* Ws2812Encoder::encode(const uint8_t* frame, size_t length, size_t& encoded) {
+    // Reuses the buffer between frames; grows only when the strip does
+    encoded = ((length * 3) + WS2812_RESET_BYTES);
+    if (this->buffer.size() < encoded) {
+        this->buffer.assign(encoded, 0);
+    }
+    const std::array<uint32_t, 256>& patterns = table();
+    uint8_t* output = this->buffer.data();
+    for (size_t i = 0; i < length; ++i) {
+        uint32_t pattern = patterns[frame[i]];
+        *output++ = (pattern >> 16);
+        *output++ = (pattern >> 8);
+        *output++ = pattern;
+    }
+    // Trailing latch bytes stay zero from allocation
+    return this->buffer.data();
+}
+
+PixelStrip::PixelStrip(uint32_t pixels, uint8_t order, StripSink* sink) {
+    static const uint8_t layouts[][4] = {
+            {0, 1, 2, 3}, {0, 2, 1, 3}, {1, 0, 2, 3}, {2, 0, 1, 3},
+            {1, 2, 0, 3}, {2, 1, 0, 3}, {0, 1, 2, 3}, {1, 0, 2, 3}
+        };
+    order = (order <= GRBW ? order : static_cast<uint8_t>(GRB));
+    for (int i = 0; i < 4; ++i) {
+        this->offsets[i] = layouts[order][i];
+    }
+    this->stride = (order >= RGBW ? 4 : 3);
+    this->pixels = pixels;
+    this->sink = sink;
+    this->frame.assign(static_cast<size_t>(pixels) * this->stride, 0);
+    this->effects.reserve(MAX_STRIP_EFFECTS);
+    #ifdef IS_EMBEDDED
+        this->timeIndex = micros();
+    #endif
+}
+
+PixelStrip::~PixelStrip() {
+    clearEffects();
+}
+
+void PixelStrip::set(uint32_t pixel, std::array<uint8_t, 4> color) {
+    if (pixel >= this->pixels) {
+        return;
+    }
+    uint8_t* destination = &this->frame[static_cast<size_t>(pixel) * this->stride];
+    for (int i = 0; i < this->stride; ++i) {
+        destination[this->offsets[i]] = color[i];
+    }
+}
+
+std::array<uint8_t, 4> PixelStrip::get(uint32_t pixel) {
+    std::array<uint8_t, 4> color = {0, 0, 0, 0};
+    if (pixel >= this->pixels) {
+        return color;
+    }
+    const uint8_t* source = &this->frame[static_cast<size_t>(pixel) * this->stride];
+    for (int i = 0; i < this->stride; ++i) {
+        color[i] = source[this->offsets[i]];
+    }
+    return color;
+}
+
+uint32_t PixelStrip::clampCount(uint32_t begin, uint32_t count) {
+    // Zero count runs to the end of the strip
+    if (begin >= this->pixels) {
+        return 0;
+    }
+    uint32_t available = (this->pixels - begin);
+    return ((!count || (count > available)) ? available : count);
+}
+
+void PixelStrip::fill(std::array<uint8_t, 4> color, uint32_t begin, uint32_t count) {
+    count = clampCount(begin, count);
+    if (!count) {
+        return;
+    }
+    // Pack one pixel in wire order, then repeat it across the range
+    uint8_t packed[4];
+    for (int i = 0; i < this->stride; ++i) {
+        packed[this->offsets[i]] = color[i];
+    }
+    uint8_t* destination = &this->frame[static_cast<size_t>(begin) * this->stride];
+    for (uint32_t p = 0; p < count; ++p, destination += this->stride) {
+        for (int i = 0; i < this->stride; ++i) {
+            destination[i] = packed[i];
+        }
+    }
+}
+
+StripEffect* PixelStrip::createEffect(
+        std::array<uint8_t, 4> target, uint32_t begin, uint32_t count,
+        double duration, double relativeStart, const Easing* easing
+    ) {
+    /* Fades a pixel range from whatever it shows when the effect
+    starts to target. Effects on a strip run concurrently rather than
+    in sequence, so separate ranges animate independently. */
+    count = clampCount(begin, count);
+    if (!count) {
+        return nullptr;
+    } else if (this->effects.size() >= MAX_STRIP_EFFECTS) {
+        print("Maximum strip effects reached");
+        return nullptr;
+    }
+    StripEffect* effect = new StripEffect;
+    effect->begin = begin;
+    effect->count = count;
+    effect->start = (this->now + static_cast<uint32_t>(relativeStart * 1e6));
+    effect->duration = static_cast<uint32_t>(duration * 1e6);
+    effect->easing = (easing != nullptr ? easing : Easing::get(Easing::LINEAR));
+    for (int i = 0; i < this->stride; ++i) {
+        effect->target[this->offsets[i]] = target[i];
+    }
+    this->effects.push_back(effect);
+    return effect;
+}
+
+uint32_t PixelStrip::effectsQueued() {
+    return this->effects.size();
+}
+
+void PixelStrip::clearEffects() {
+    for (auto effect: this->effects) {
+        delete effect;
+    }
+    this->effects.clear();
+}
+
+void PixelStrip::activate(StripEffect* effect) {
+    const uint8_t* range = &this->frame[static_cast<size_t>(effect->begin) * this->stride];
+    effect->origin.assign(range, range + (static_cast<size_t>(effect->count) * this->stride));
+    effect->active = true;
+}
+
+bool PixelStrip::step(StripEffect* effect) {
+    // Writes the range for the current time; returns whether finished
+    effect->position = (this->now - effect->start);
+    uint16_t progress = Easing::progress(effect->position, effect->duration);
+    // Scaled to 0 - 65536 so the final step lands exactly on target
+    uint32_t eased = ((progress == 65535) ? 65536 : effect->easing->evaluate(progress));
+    uint8_t* destination = &this->frame[static_cast<size_t>(effect->begin) * this->stride];
+    const uint8_t* origin = effect->origin.data();
+    size_t length = (static_cast<size_t>(effect->count) * this->stride);
+    for (size_t i = 0, channel = 0; i < length; ++i) {
+        int32_t from = origin[i];
+        destination[i] = (from + (((static_cast<int32_t>(effect->target[channel]) - from) * static_cast<int32_t>(eased)) >> 16));
+        channel = ((channel + 1) == this->stride ? 0 : (channel + 1));
+    }
+    return (progress == 65535);
+}
+
+void PixelStrip::show() {
+    if (this->sink == nullptr) {
+        return;
+    }
+    size_t encoded;
+    const uint8_t* data = this->encoder.encode(this->frame.data(), this->frame.size(), encoded);
+    this->sink->write(data, encoded);
+}
+
+void PixelStrip::run() {
+    #ifdef IS_EMBEDDED
+        uint32_t sampled = micros();
+        this->now += (sampled - this->timeIndex);
+        this->timeIndex = sampled;
+    #endif
+    run(this->now);
+}
+
+void PixelStrip::run(uint32_t currentTime) {
+    // Steps every started effect in creation order, then sends the frame
+    this->now = currentTime;
+    size_t kept = 0;
+    for (size_t i = 0; i < this->effects.size(); ++i) {
+        StripEffect* effect = this->effects[i];
+        if (static_cast<int32_t>(this->now - effect->start) < 0) {
+            this->effects[kept++] = effect;
+            continue;
+        }
+        if (!effect->active) {
+            activate(effect);
+        }
+        if (step(effect)) {
+            delete effect;
+        } else {
+            this->effects[kept++] = effect;
+        }
+    }
+    this->effects.resize(kept);
+    show();
+}
@@ -0,0 +1,118 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef PIXELSTRIP_H
+#define PIXELSTRIP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <vector>
+#include "SimpleSerialBase.h"
+#include "Easing.h"
+
+#define WS2812_SPI_FREQUENCY    2400000 // Three line bits per data bit at 800 kHz
+#define WS2812_RESET_BYTES      90 // Low for >280 us latches the frame
+#define MAX_STRIP_EFFECTS       256
+
+class StripSink {
+    // Destination for encoded frames
+    public:
+        virtual ~StripSink() {}
+        virtual void write(const uint8_t* data, size_t length) = 0;
+};
+
+class MemorySink : public StripSink {
+    // Keeps the last encoded frame; for host tests and benchmarks
+    public:
+        std::vector<uint8_t> data;
+        uint32_t frames = 0;
+        void write(const uint8_t* data, size_t length) override;
+};
+
+#if ESP32
+class SpiSink : public StripSink {
+    // Clocks frames out of the SPI MOSI pin; only the data line is used
+    public:
+        SpiSink(int8_t pin, uint32_t frequency=WS2812_SPI_FREQUENCY);
+        void write(const uint8_t* data, size_t length) override;
+    protected:
+        uint32_t frequency;
+};
+#endif
+
+class Ws2812Encoder {
+    /* Expands frame bytes into the WS2812 line pattern for an SPI
+    peripheral at 2.4 MHz: each data bit becomes 110 (one) or 100
+    (zero), MSB first, so every byte costs one table lookup. */
+    public:
+        std::vector<uint8_t> buffer;
+        const uint8_t* encode(const uint8_t* frame, size_t length, size_t& encoded);
+        static uint32_t expand(uint8_t);
+    protected:
+        static const std::array<uint32_t, 256>& table();
+};
+
+struct StripEffect {
+    uint32_t begin, count, start, duration, position = 0;
+    std::array<uint8_t, 4> target; // Wire order
+    std::vector<uint8_t> origin; // Range contents at activation
+    const Easing* easing;
+    bool active = false;
+};
+
+class PixelStrip : public SimpleSerialBase {
+    /* Framebuffer for addressable strips, held packed in the strip's
+    own byte order so a frame goes to the encoder without reshuffling.
+    Colors are passed as RGB(W) and placed according to order. */
+    public:
+        enum Order : uint8_t {RGB, RBG, GRB, GBR, BRG, BGR, RGBW, GRBW};
+        std::vector<uint8_t> frame;
+        std::vector<StripEffect*> effects;
+        std::array<uint8_t, 4> offsets; // Wire position of R, G, B, W
+        uint32_t pixels, now = 0, timeIndex = 0;
+        uint8_t stride;
+        Ws2812Encoder encoder;
+        StripSink* sink;
+        PixelStrip(uint32_t pixels, uint8_t order=GRB, StripSink* sink=nullptr);
+        ~PixelStrip();
+        void set(uint32_t pixel, std::array<uint8_t, 4> color);
+        std::array<uint8_t, 4> get(uint32_t pixel);
+        void fill(std::array<uint8_t, 4> color, uint32_t begin=0, uint32_t count=0);
+        StripEffect* createEffect(
+                std::array<uint8_t, 4> target, uint32_t begin=0, uint32_t count=0,
+                double duration=1, double relativeStart=0, const Easing* easing=nullptr
+            );
+        uint32_t effectsQueued();
+        void clearEffects();
+        void show();
+        void run();
+        void run(uint32_t currentTime);
+    protected:
+        uint32_t clampCount(uint32_t begin, uint32_t count);
+        void activate(StripEffect*);
+        bool step(StripEffect*);
+};
+
+#endif
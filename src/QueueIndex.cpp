@@ -0,0 +1,395 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "QueueIndex.h"
+#include <algorithm>
+
+template <unsigned int N>
+void QueueIndex<N>::build(
+        const std::vector<Effect<N>*>& effects, const Scheduler<N>* scheduler,
+        const std::array<ColorChannel*, N>& channels, uint32_t now, uint32_t revision
+    ) {
+    /* Replays the queue's ordering rules symbolically: an effect starts
+    when the one before it completes, or at its own start if later;
+    a looping effect rejoins the back of the queue. The scheduler's
+    effects go to the front as they fall due, cutting short whatever
+    is playing. */
+    this->groups.clear();
+    this->spans.clear();
+    this->pauses.clear();
+    this->channels = &channels;
+    this->now = now;
+    this->anchor = now;
+    this->revision = revision;
+    this->valid = true;
+    this->truncated = false;
+    for (int i = 0; i < N; ++i) {
+        this->initial[i] = channels[i]->get();
+    }
+    auto delay = [now](const Effect<N>* effect) {
+        int32_t remaining = static_cast<int32_t>(effect->start - now);
+        return static_cast<uint64_t>((remaining > 0) ? remaining : 0);
+    };
+    std::vector<Pending> queue, due;
+    for (size_t i = 0; i < effects.size(); ++i) {
+        Effect<N>* effect = effects[i];
+        bool resumed = (!i && effect->active);
+        queue.push_back({effect, effect->loop, (resumed ? 0 : delay(effect)), resumed, effect->aborted});
+    }
+    if (scheduler != nullptr) {
+        for (const auto& entry: scheduler->heap) {
+            due.push_back({entry.effect, entry.effect->loop, delay(entry.effect), false, entry.effect->aborted});
+        }
+        std::stable_sort(due.begin(), due.end(), [](const Pending& first, const Pending& second) {
+                return (first.ready < second.ready);
+            });
+    }
+    std::array<uint16_t, N> state = this->initial;
+    uint64_t time = 0;
+    size_t head = 0, released = 0;
+    while (this->spans.size() < QUEUE_INDEX_MAX_SPANS) {
+        for (size_t ahead = head; (released < due.size()) && (due[released].ready <= time); ++released) {
+            queue.insert((queue.begin() + ahead++), due[released]);
+        }
+        if (head == queue.size()) {
+            if (released == due.size()) {
+                break;
+            }
+            time = due[released].ready;
+            continue;
+        }
+        // Only loops left, all free to start: the cycle is fixed from here
+        bool cyclic = true;
+        for (size_t i = head; cyclic && (i < queue.size()); ++i) {
+            const Pending& member = queue[i];
+            cyclic = (member.passes && !member.resumed && !member.skipped && (member.ready <= time));
+        }
+        if (cyclic) {
+            std::vector<Pending> members(queue.begin() + head, queue.end());
+            uint64_t rounds = QUEUE_INDEX_FOREVER;
+            for (const auto& member: members) {
+                if (member.passes > 0) {
+                    rounds = std::min<uint64_t>(rounds, (member.passes + 1));
+                }
+            }
+            uint64_t nextDue = ((released < due.size()) ? due[released].ready : QUEUE_INDEX_FOREVER);
+            std::array<uint16_t, N> before = state;
+            size_t spanMark = this->spans.size(), pauseMark = this->pauses.size();
+            uint64_t first = round(members, state, time, 1);
+            if ((first == QUEUE_INDEX_FOREVER) && (nextDue == QUEUE_INDEX_FOREVER)) {
+                break;
+            }
+            if ((first != QUEUE_INDEX_FOREVER) && ((time + first) < nextDue)) {
+                // Later rounds start from the first round's end, so are all alike
+                time += first;
+                uint64_t repeats = ((rounds == QUEUE_INDEX_FOREVER) ? rounds : (rounds - 1));
+                if (repeats) {
+                    spanMark = this->spans.size();
+                    pauseMark = this->pauses.size();
+                    std::array<uint16_t, N> repeated = state;
+                    uint64_t length = round(members, repeated, time, repeats);
+                    if ((nextDue != QUEUE_INDEX_FOREVER) && length) {
+                        // Stop short of the next scheduled release; a pass ending on it is cut
+                        repeats = std::min<uint64_t>(repeats, ((nextDue - time - 1) / length));
+                    }
+                    if (!repeats) {
+                        this->groups.pop_back();
+                        this->spans.resize(spanMark);
+                        this->pauses.resize(pauseMark);
+                    } else if (repeats == QUEUE_INDEX_FOREVER) {
+                        break;
+                    } else {
+                        this->groups.back().rounds = repeats;
+                        state = repeated;
+                        time += (length * repeats);
+                    }
+                }
+                uint64_t completed = (repeats + 1);
+                queue.clear();
+                head = 0;
+                for (auto member: members) {
+                    if ((member.passes < 0) || (static_cast<uint64_t>(member.passes) >= completed)) {
+                        member.passes -= ((member.passes < 0) ? 0 : completed);
+                        queue.push_back(member);
+                    }
+                }
+                continue;
+            }
+            // The scheduler releases an effect mid-round; go one pass at a time
+            this->groups.pop_back();
+            this->spans.resize(spanMark);
+            this->pauses.resize(pauseMark);
+            state = before;
+        }
+        Pending current = queue[head];
+        uint64_t start = std::max(time, current.ready);
+        uint64_t nextDue = ((released < due.size()) ? due[released].ready : QUEUE_INDEX_FOREVER);
+        if (nextDue <= start) {
+            // Released while this effect waits to start, so goes first
+            time = nextDue;
+            continue;
+        }
+        head++;
+        Span span = measure(current, state);
+        span.offset = 0;
+        bool cut = ((nextDue != QUEUE_INDEX_FOREVER) && ((span.length == QUEUE_INDEX_FOREVER) || ((start + span.length) >= nextDue)));
+        if (cut) {
+            span.length = (nextDue - start);
+        }
+        this->groups.push_back({start, span.length, 1, static_cast<uint32_t>(this->spans.size()), 1});
+        this->spans.push_back(span);
+        if (span.length == QUEUE_INDEX_FOREVER) {
+            break;
+        }
+        time = (start + span.length);
+        if (cut) {
+            // Cancelled mid-pass; channels stay where it left them
+            state = evaluate(span, span.length);
+            continue;
+        }
+        state = finish(span, state);
+        if (current.passes) {
+            queue.push_back({current.effect, ((current.passes > 0) ? (current.passes - 1) : -1), 0, false, false});
+        }
+    }
+    this->truncated = (this->spans.size() >= QUEUE_INDEX_MAX_SPANS);
+}
+
+template <unsigned int N>
+uint64_t QueueIndex<N>::round(
+        const std::vector<Pending>& members, std::array<uint16_t, N>& state,
+        uint64_t time, uint64_t rounds
+    ) {
+    // Appends one group of members end to end; returns its length
+    Group group = {time, 0, rounds, static_cast<uint32_t>(this->spans.size()), 0};
+    for (const auto& member: members) {
+        Span span = measure(member, state);
+        span.offset = group.length;
+        this->spans.push_back(span);
+        group.spans++;
+        if (span.length == QUEUE_INDEX_FOREVER) {
+            group.length = QUEUE_INDEX_FOREVER;
+            break;
+        }
+        group.length += span.length;
+        state = finish(span, state);
+    }
+    this->groups.push_back(group);
+    return group.length;
+}
+
+template <unsigned int N>
+typename QueueIndex<N>::Span QueueIndex<N>::measure(
+        const Pending& pending, const std::array<uint16_t, N>& origin
+    ) {
+    /* Fade and hold timing of one pass, as Effect::run() would play it
+    from origin. The live effect resumes from its own position, steps
+    and holds instead. */
+    Effect<N>* effect = pending.effect;
+    Span span = {};
+    span.effect = effect;
+    span.origin = origin;
+    span.firstPause = this->pauses.size();
+    bool analytic = effect->analytic();
+    for (int i = 0; i < N; ++i) {
+        ColorChannel* channel = (*this->channels)[i];
+        span.target[i] = (
+                !effect->drives(i) ? origin[i]
+                : (analytic ? effect->target[i] : channel->conform((channel->scale * effect->target[i]) + channel->offset))
+            );
+    }
+    if (pending.skipped) {
+        // Cancelled effects are dropped as soon as they reach the front
+        span.target = origin;
+        return span;
+    }
+    if (effect->indefinite()) {
+        span.entry = (pending.resumed ? effect->position : 0);
+        span.fade = UINT32_MAX;
+        span.length = QUEUE_INDEX_FOREVER;
+        // Holds run back to back from the current position
+        for (auto hold: effect->holds) {
+            if (!hold->complete || !pending.resumed) {
+                int64_t length = ((hold->active && pending.resumed) ? hold->remaining : hold->duration);
+                this->pauses.push_back({0, static_cast<uint64_t>(std::max<int64_t>(length, 0))});
+            }
+        }
+        span.pauses = (this->pauses.size() - span.firstPause);
+        return span;
+    }
+    uint32_t total, stepLength = 1;
+    if (analytic) {
+        if (pending.resumed) {
+            span.origin = effect->origin;
+            span.entry = effect->position;
+        }
+        total = effect->duration;
+        span.fade = (total - span.entry);
+    } else if (pending.resumed) {
+        span.steps = effect->stepsRemaining;
+        stepLength = effect->stepLength;
+        total = effect->totalSteps;
+        span.fade = (span.steps * stepLength);
+    } else {
+        for (int i = 0; i < N; ++i) {
+            if (effect->drives(i)) {
+                span.steps = std::max<uint32_t>(span.steps, std::abs(span.target[i] - origin[i]));
+            }
+        }
+        if (!span.steps) {
+            // Already at target; the queue moves straight on
+            return span;
+        }
+        stepLength = std::max<uint32_t>((effect->duration / span.steps), 1);
+        total = span.steps;
+        span.fade = (span.steps * stepLength);
+    }
+    // Holds trigger in order, each once the one before it has finished
+    uint64_t at = 0, held = 0;
+    auto pause = [&](const Hold* hold, bool fresh) {
+        if (hold->complete && !fresh) {
+            return;
+        }
+        uint32_t threshold = (fresh ? static_cast<uint32_t>(total - (total * hold->start)) : hold->threshold);
+        // Microseconds or steps left when the pass begins
+        uint32_t remaining = (analytic ? (total - span.entry) : span.steps);
+        uint64_t trigger = ((remaining > threshold) ? (remaining - threshold) : 0);
+        at = std::max(at, (analytic ? trigger : (trigger * stepLength)));
+        int64_t length = ((hold->active && !fresh) ? hold->remaining : hold->duration);
+        length = std::max<int64_t>(length, 0);
+        this->pauses.push_back({at, static_cast<uint64_t>(length)});
+        held += length;
+    };
+    for (auto hold: effect->holds) {
+        pause(hold, !pending.resumed);
+    }
+    if (!pending.resumed) {
+        // Holds kept from a previous pass rejoin behind any new ones
+        for (auto hold: effect->secondaryHolds) {
+            pause(hold, true);
+        }
+    }
+    span.pauses = (this->pauses.size() - span.firstPause);
+    span.length = (span.fade + held);
+    return span;
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> QueueIndex<N>::evaluate(const Span& span, uint64_t offset) {
+    // Output offset microseconds into a span; holds freeze the fade
+    const Pause* pause = (this->pauses.data() + span.firstPause);
+    for (uint32_t i = 0; i < span.pauses; ++i, ++pause) {
+        if (offset <= pause->at) {
+            break;
+        } else if (offset <= (pause->at + pause->length)) {
+            offset = pause->at;
+            break;
+        }
+        offset -= pause->length;
+    }
+    if (!span.fade) {
+        return finish(span, span.origin);
+    }
+    uint32_t fade = static_cast<uint32_t>(std::min<uint64_t>(offset, span.fade));
+    if (!span.steps) {
+        return span.effect->evaluate((span.entry + fade), span.origin);
+    }
+    // Linear stepping, every channel arriving with the longest
+    uint32_t done = static_cast<uint32_t>((static_cast<uint64_t>(fade) * span.steps) / span.fade);
+    std::array<uint16_t, N> values;
+    for (int i = 0; i < N; ++i) {
+        int32_t delta = (span.target[i] - span.origin[i]);
+        values[i] = (span.origin[i] + ((static_cast<int64_t>(delta) * done) / span.steps));
+    }
+    return values;
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> QueueIndex<N>::finish(
+        const Span& span, const std::array<uint16_t, N>& origin
+    ) {
+    std::array<uint16_t, N> values;
+    for (int i = 0; i < N; ++i) {
+        values[i] = (span.effect->drives(i) ? span.target[i] : origin[i]);
+    }
+    return values;
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> QueueIndex<N>::evaluate(uint32_t time, bool* known) {
+    /* Output at time on the writer's clock, from the anchor to ~35
+    minutes after it. Outside that window, or past the last indexed
+    pass, known is cleared and the state at the anchor returned. */
+    int32_t relative = static_cast<int32_t>(time - this->anchor);
+    uint64_t offset = relative;
+    bool predicted = (this->valid && (relative >= 0) && (!this->truncated || (offset < length())));
+    if (known != nullptr) {
+        *known = predicted;
+    }
+    if (!predicted) {
+        return this->initial;
+    }
+    auto group = std::upper_bound(
+            this->groups.begin(), this->groups.end(), offset,
+            [](uint64_t value, const Group& other) {
+                return (value < other.start);
+            }
+        );
+    if (group == this->groups.begin()) {
+        return this->initial;
+    }
+    --group;
+    offset -= group->start;
+    if (group->length && (group->length != QUEUE_INDEX_FOREVER)) {
+        uint64_t completed = std::min<uint64_t>((offset / group->length), (group->rounds - 1));
+        offset -= (completed * group->length);
+    }
+    const Span* first = (this->spans.data() + group->firstSpan);
+    const Span* span = (std::upper_bound(
+            first, (first + group->spans), offset,
+            [](uint64_t value, const Span& other) {
+                return (value < other.offset);
+            }
+        ) - 1);
+    return evaluate(*span, (offset - span->offset));
+}
+
+template <unsigned int N>
+uint64_t QueueIndex<N>::length() {
+    // Microseconds from the anchor until the queue settles
+    if (this->groups.empty()) {
+        return 0;
+    }
+    const Group& last = this->groups.back();
+    if ((last.length == QUEUE_INDEX_FOREVER) || (last.rounds == QUEUE_INDEX_FOREVER)) {
+        return QUEUE_INDEX_FOREVER;
+    }
+    return (last.start + (last.length * last.rounds));
+}
+
+template <unsigned int N>
+void QueueIndex<N>::invalidate() {
+    // For changes made behind the writer's back, e.g. holds set on an effect directly
+    this->valid = false;
+}
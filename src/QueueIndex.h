@@ -0,0 +1,100 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef QUEUEINDEX_H
+#define QUEUEINDEX_H
+
+#include <stdint.h>
+#include <vector>
+#include "Effect.h"
+#include "Scheduler.h"
+
+#define QUEUE_INDEX_FOREVER     UINT64_MAX
+#define QUEUE_INDEX_MAX_SPANS   16384 // Passes indexed before prediction stops
+
+template <unsigned int N=3>
+class QueueIndex : public SimpleSerialBase {
+    /* Predicts queue output at any time without touching live state.
+    Built from a snapshot of the queue: each pass of each effect
+    becomes a span with its own origin, fade and holds, laid end to
+    end. Once only looping effects remain, every round after the first
+    is identical, so those rounds collapse into one group with a repeat
+    count; loops of any length index in space proportional to the
+    queue. Lookups binary search groups, then spans within a round. */
+    public:
+        struct Pause {
+            uint64_t at, length; // Microseconds of fade, then of hold
+        };
+        struct Span {
+            Effect<N>* effect;
+            uint64_t offset; // From the start of the round
+            uint64_t length; // Fade plus holds; QUEUE_INDEX_FOREVER if endless
+            uint32_t entry; // Fade position the span starts from
+            uint32_t fade; // Microseconds of fade remaining from entry
+            uint32_t steps; // Linear steps; 0 for analytic effects
+            uint32_t firstPause, pauses;
+            std::array<uint16_t, N> origin, target;
+        };
+        struct Group {
+            uint64_t start; // From anchor
+            uint64_t length; // One round
+            uint64_t rounds; // QUEUE_INDEX_FOREVER repeats endlessly
+            uint32_t firstSpan, spans;
+        };
+        std::vector<Group> groups;
+        std::vector<Span> spans;
+        std::vector<Pause> pauses;
+        std::array<uint16_t, N> initial;
+        uint32_t anchor = 0, revision = 0;
+        bool valid = false, truncated = false; // Truncated: stopped at QUEUE_INDEX_MAX_SPANS
+        void build(
+                const std::vector<Effect<N>*>& effects, const Scheduler<N>* scheduler,
+                const std::array<ColorChannel*, N>& channels, uint32_t now, uint32_t revision
+            );
+        std::array<uint16_t, N> evaluate(uint32_t time, bool* known=nullptr);
+        uint64_t length();
+        void invalidate();
+    protected:
+        struct Pending {
+            Effect<N>* effect;
+            int64_t passes; // Further passes after this one; -1 endless
+            uint64_t ready; // Earliest start from anchor
+            bool resumed; // The live effect, part way through its pass
+            bool skipped; // Cancelled; ends without output
+        };
+        const std::array<ColorChannel*, N>* channels;
+        uint32_t now;
+        Span measure(const Pending& pending, const std::array<uint16_t, N>& origin);
+        std::array<uint16_t, N> evaluate(const Span& span, uint64_t offset);
+        std::array<uint16_t, N> finish(const Span& span, const std::array<uint16_t, N>& origin);
+        uint64_t round(const std::vector<Pending>& members, std::array<uint16_t, N>& state, uint64_t time, uint64_t rounds);
+};
+
+template class QueueIndex<1>;
+template class QueueIndex<2>;
+template class QueueIndex<3>;
+template class QueueIndex<4>;
+template class QueueIndex<5>;
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Random.h"
+
+Random::Random(uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+Random& Random::shared() {
+    // Fallback for effects created without a writer's generator
+    static Random generator;
+    return generator;
+}
+
+void Random::seed(uint64_t seed, uint64_t stream) {
+    this->state = 0;
+    this->increment = ((stream << 1) | 1);
+    next();
+    this->state += seed;
+    next();
+}
+
+uint32_t Random::next() {
+    uint64_t previous = this->state;
+    this->state = ((previous * 6364136223846793005ULL) + this->increment);
+    uint32_t shifted = (((previous >> 18) ^ previous) >> 27);
+    uint32_t rotation = (previous >> 59);
+    return ((shifted >> rotation) | (shifted << ((-rotation) & 31)));
+}
+
+uint32_t Random::below(uint32_t bound) {
+    // Unbiased 0 to bound - 1 by multiply and reject; no division on the fast path
+    if (!bound) {
+        return 0;
+    }
+    uint64_t product = (static_cast<uint64_t>(next()) * bound);
+    uint32_t low = product;
+    if (low < bound) {
+        uint32_t threshold = ((-bound) % bound);
+        while (low < threshold) {
+            product = (static_cast<uint64_t>(next()) * bound);
+            low = product;
+        }
+    }
+    return (product >> 32);
+}
+
+int32_t Random::range(int32_t boundary) {
+    // Uniform within -boundary to +boundary inclusive
+    if (boundary <= 0) {
+        return 0;
+    }
+    return (static_cast<int32_t>(below((static_cast<uint32_t>(boundary) * 2) + 1)) - boundary);
+}
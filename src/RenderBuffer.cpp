@@ -0,0 +1,354 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "RenderBuffer.h"
+
+#if ESP32 || !defined(IS_EMBEDDED)
+
+#ifndef IS_EMBEDDED
+    #include <chrono>
+#endif
+
+#ifdef __linux__
+    #include <sys/timerfd.h>
+    #include <unistd.h>
+#endif
+
+template <unsigned int N>
+RenderBuffer<N>::RenderBuffer(LedWriter<N>* writer, double lookahead, double rate) {
+    this->writer = writer;
+    this->interval = ((rate > 0) ? static_cast<uint32_t>(1e6 / rate) : 1000);
+    if (!this->interval) {
+        this->interval = 1;
+    }
+    // One spare slot so a full look-ahead fits while output() holds a frame
+    uint32_t ahead = static_cast<uint32_t>(ceil((lookahead * 1e6) / this->interval));
+    this->capacity = 2;
+    while ((this->capacity < (ahead + 2)) && (this->capacity < RENDER_MAX_FRAMES)) {
+        this->capacity <<= 1;
+    }
+    this->mask = (this->capacity - 1);
+    this->lookahead = std::min<uint32_t>(ahead, (this->capacity - 2)) * this->interval;
+    this->frames = new RenderFrame<N>[this->capacity];
+    this->sent.fill(0);
+}
+
+template <unsigned int N>
+RenderBuffer<N>::~RenderBuffer() {
+    stop();
+    delete[] this->frames;
+    this->frames = nullptr;
+}
+
+template <unsigned int N>
+uint32_t RenderBuffer<N>::sampleClock() {
+    #ifdef IS_EMBEDDED
+        return micros();
+    #else
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count());
+    #endif
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::start() {
+    start(sampleClock());
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::start(uint32_t currentTime) {
+    /* Hands the writer's outputs to the ring. Call before output() is
+    running; the first frames are rendered on the next render(). */
+    for (unsigned int i = 0; i < N; ++i) {
+        this->writer->channels[i]->deferred = true;
+    }
+    this->head.store(0, std::memory_order_relaxed);
+    this->tail.store(0, std::memory_order_relaxed);
+    this->rendered = currentTime;
+    this->underruns = this->skipped = this->resumed = 0;
+    this->primed = false;
+    this->started = true;
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::stop() {
+    // Returns the outputs to the writer at its rendered state
+    if (!this->started) {
+        return;
+    }
+    stopOutput();
+    stopTimer();
+    this->started = false;
+    for (unsigned int i = 0; i < N; ++i) {
+        ColorChannel* channel = this->writer->channels[i];
+        channel->deferred = false;
+        channel->output(channel->written);
+    }
+}
+
+template <unsigned int N>
+uint32_t RenderBuffer<N>::render() {
+    return render(sampleClock());
+}
+
+template <unsigned int N>
+uint32_t RenderBuffer<N>::render(uint32_t currentTime) {
+    /* Renders frames until the look-ahead is covered or the ring is
+    full, and returns how many were added. */
+    if (!this->started) {
+        return 0;
+    }
+    if (static_cast<int32_t>(this->rendered - currentTime) < 0) {
+        // Fell behind; frames already due would only be skipped
+        this->rendered = currentTime;
+        this->resumed++;
+    }
+    uint32_t horizon = (currentTime + this->lookahead), count = 0;
+    uint32_t head = this->head.load(std::memory_order_relaxed);
+    while (
+            (static_cast<int32_t>(this->rendered - horizon) <= 0) &&
+            ((head - this->tail.load(std::memory_order_acquire)) < this->capacity)
+        ) {
+        this->writer->run(this->rendered);
+        RenderFrame<N>& frame = this->frames[head & this->mask];
+        frame.time = this->rendered;
+        for (unsigned int i = 0; i < N; ++i) {
+            frame.values[i] = this->writer->channels[i]->written;
+        }
+        this->head.store(++head, std::memory_order_release);
+        this->rendered += this->interval;
+        ++count;
+    }
+    return count;
+}
+
+template <unsigned int N>
+bool RenderBuffer<N>::output() {
+    return output(sampleClock());
+}
+
+template <unsigned int N>
+bool RenderBuffer<N>::output(uint32_t currentTime) {
+    /* Sends the latest frame that is due, writing only channels that
+    changed. Touches nothing but the ring and the hardware, so it may
+    run concurrently with render(). */
+    uint32_t tail = this->tail.load(std::memory_order_relaxed);
+    uint32_t head = this->head.load(std::memory_order_acquire);
+    if (tail == head) {
+        if (this->primed) {
+            this->underruns++;
+        }
+        return false;
+    }
+    if (static_cast<int32_t>(this->frames[tail & this->mask].time - currentTime) > 0) {
+        return false;
+    }
+    while (
+            ((head - tail) > 1) &&
+            (static_cast<int32_t>(this->frames[(tail + 1) & this->mask].time - currentTime) <= 0)
+        ) {
+        ++tail;
+        this->skipped++;
+    }
+    const RenderFrame<N>& frame = this->frames[tail & this->mask];
+    for (unsigned int i = 0; i < N; ++i) {
+        if (!this->primed || (frame.values[i] != this->sent[i])) {
+            this->writer->channels[i]->send(frame.values[i]);
+            this->sent[i] = frame.values[i];
+        }
+    }
+    this->primed = true;
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <unsigned int N>
+bool RenderBuffer<N>::tick() {
+    /* Output stage for a periodic timer. No allocation, logging or
+    locking, and bounded by the ring size, so it is safe from the
+    esp_timer task or the timerfd thread; not from a raw ISR, as
+    ColorChannel output goes through driver calls. */
+    return output(sampleClock());
+}
+
+template <unsigned int N>
+uint32_t RenderBuffer<N>::buffered() {
+    return (this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire));
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::startOutput(uint8_t priority) {
+    /* Runs output() once per frame from its own task, above the
+    priority of loop(), which keeps calling render(). */
+    if (!this->started) {
+        return;
+    }
+    #if ESP32
+        if (this->timer != nullptr) {
+            return;
+        }
+        if (this->outputTask == nullptr) {
+            xTaskCreatePinnedToCore(consumer, "render", 4096, this, priority, &this->outputTask, 1);
+        }
+    #elif !defined(IS_EMBEDDED)
+        // Host threads keep the scheduler's default priority
+        (void) priority;
+        if (this->timing.load()) {
+            return;
+        }
+        if (!this->running.exchange(true)) {
+            this->outputThread = std::thread(consumer, this);
+        }
+    #else
+        (void) priority;
+    #endif
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::stopOutput() {
+    #if ESP32
+        if (this->outputTask != nullptr) {
+            vTaskDelete(this->outputTask);
+            this->outputTask = nullptr;
+        }
+    #elif !defined(IS_EMBEDDED)
+        if (this->running.exchange(false)) {
+            this->outputThread.join();
+        }
+    #endif
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::consumer(void* parameter) {
+    RenderBuffer<N>* buffer = static_cast<RenderBuffer<N>*>(parameter);
+    #if ESP32
+        // The scheduler tick bounds the rate; finer frames need a timer
+        TickType_t wake = xTaskGetTickCount();
+        TickType_t period = std::max<TickType_t>(1, pdMS_TO_TICKS(buffer->interval / 1000));
+        while (true) {
+            buffer->output();
+            vTaskDelayUntil(&wake, period);
+        }
+    #elif !defined(IS_EMBEDDED)
+        auto wake = std::chrono::steady_clock::now();
+        while (buffer->running.load(std::memory_order_relaxed)) {
+            buffer->output();
+            wake += std::chrono::microseconds(buffer->interval);
+            std::this_thread::sleep_until(wake);
+        }
+    #endif
+}
+
+template <unsigned int N>
+bool RenderBuffer<N>::startTimer() {
+    /* Calls tick() once per frame from a periodic timer in place of an
+    output task, so the frame rate is not bound to the scheduler tick.
+    loop() keeps calling render(). */
+    if (!this->started) {
+        return false;
+    }
+    #if ESP32
+        if (this->outputTask != nullptr) {
+            return false;
+        }
+        if (this->timer != nullptr) {
+            return true;
+        }
+        // Dispatched from the timer's top-priority task, as ledcWrite takes a lock
+        esp_timer_create_args_t arguments = {};
+        arguments.callback = timerCallback;
+        arguments.arg = this;
+        arguments.name = "render";
+        if (esp_timer_create(&arguments, &this->timer) != ESP_OK) {
+            this->timer = nullptr;
+            print("Unable to create output timer");
+            return false;
+        }
+        esp_timer_start_periodic(this->timer, this->interval);
+        return true;
+    #elif defined(__linux__)
+        if (this->running.load()) {
+            return false;
+        }
+        if (this->timing.load()) {
+            return true;
+        }
+        this->timerDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (this->timerDescriptor < 0) {
+            print("Unable to create output timer");
+            return false;
+        }
+        struct itimerspec period = {};
+        period.it_interval.tv_sec = (this->interval / 1000000);
+        period.it_interval.tv_nsec = ((this->interval % 1000000) * 1000);
+        period.it_value = period.it_interval;
+        timerfd_settime(this->timerDescriptor, 0, &period, nullptr);
+        this->timing.store(true);
+        this->timerThread = std::thread(timerCallback, this);
+        return true;
+    #else
+        print("No periodic timer; use startOutput()");
+        return false;
+    #endif
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::stopTimer() {
+    #if ESP32
+        if (this->timer != nullptr) {
+            esp_timer_stop(this->timer);
+            esp_timer_delete(this->timer);
+            this->timer = nullptr;
+        }
+    #elif defined(__linux__)
+        if (this->timing.exchange(false)) {
+            this->timerThread.join();
+            close(this->timerDescriptor);
+            this->timerDescriptor = -1;
+        }
+    #endif
+}
+
+template <unsigned int N>
+void RenderBuffer<N>::timerCallback(void* parameter) {
+    RenderBuffer<N>* buffer = static_cast<RenderBuffer<N>*>(parameter);
+    #if ESP32
+        buffer->tick();
+    #elif defined(__linux__)
+        // Stands in for the esp_timer task; each read blocks until the next expiry
+        uint64_t expirations;
+        while (buffer->timing.load(std::memory_order_relaxed)) {
+            if (read(buffer->timerDescriptor, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                continue;
+            }
+            buffer->overruns += (expirations - 1);
+            buffer->tick();
+        }
+    #else
+        (void) buffer;
+    #endif
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef RENDERBUFFER_H
+#define RENDERBUFFER_H
+
+#include <stdint.h>
+#include "LedWriter.h"
+
+#if ESP32 || !defined(IS_EMBEDDED)
+
+#include <atomic>
+
+#if ESP32
+    #include <esp_timer.h>
+#elif !defined(IS_EMBEDDED)
+    #include <thread>
+#endif
+
+#define RENDER_AHEAD        0.05 // Default seconds rendered ahead of output
+#define RENDER_RATE         1000 // Default frames per second
+#define RENDER_MAX_FRAMES   4096
+
+template <unsigned int N=3>
+struct RenderFrame {
+    uint32_t time;
+    std::array<uint16_t, N> values;
+};
+
+template <unsigned int N=3>
+class RenderBuffer : public SimpleSerialBase {
+    /* Pipelines a writer: render() runs the effect queue ahead of real
+    time from the low-priority context that owns the queue, e.g. loop(),
+    and stores each frame of channel values in a ring; output() sends
+    the frame that is due from a timer or high-priority task. A late
+    render() only eats into the look-ahead instead of replaying a burst
+    of steps on the outputs. Queue changes reach the outputs after the
+    look-ahead. */
+    public:
+        LedWriter<N>* writer;
+        RenderFrame<N>* frames;
+        uint32_t capacity, mask, interval, lookahead;
+        uint32_t rendered = 0; // Time of the next frame to render
+        uint32_t underruns = 0, // output() calls that found the ring empty
+            skipped = 0, // Frames passed over by a late output()
+            resumed = 0, // Times render() fell behind real time
+            overruns = 0; // Timer periods that passed without a tick()
+        bool started = false;
+        std::array<uint16_t, N> sent;
+        RenderBuffer(LedWriter<N>* writer, double lookahead=RENDER_AHEAD, double rate=RENDER_RATE);
+        ~RenderBuffer();
+        void start();
+        void start(uint32_t currentTime);
+        void stop();
+        uint32_t render();
+        uint32_t render(uint32_t currentTime);
+        bool output();
+        bool output(uint32_t currentTime);
+        bool tick();
+        uint32_t buffered();
+        void startOutput(uint8_t priority=5);
+        void stopOutput();
+        bool startTimer();
+        void stopTimer();
+        static uint32_t sampleClock();
+    protected:
+        std::atomic<uint32_t> head{0}, tail{0}; // Written by render() and output() respectively
+        bool primed = false;
+        static void consumer(void* parameter);
+        static void timerCallback(void* parameter);
+        #if ESP32
+            TaskHandle_t outputTask = nullptr;
+            esp_timer_handle_t timer = nullptr;
+        #elif !defined(IS_EMBEDDED)
+            std::thread outputThread, timerThread;
+            std::atomic<bool> running{false}, timing{false};
+            int timerDescriptor = -1;
+        #endif
+};
+
+template class RenderBuffer<1>;
+template class RenderBuffer<2>;
+template class RenderBuffer<3>;
+template class RenderBuffer<4>;
+template class RenderBuffer<5>;
+
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Scheduler.h"
+
+template <unsigned int N>
+Scheduler<N>::Scheduler(size_t capacity) {
+    this->capacity = capacity;
+}
+
+template <unsigned int N>
+void Scheduler<N>::advance(uint32_t now) {
+    // Unsigned difference absorbs 32-bit clock rollover
+    this->clock += static_cast<uint32_t>(now - this->last);
+    this->last = now;
+}
+
+template <unsigned int N>
+uint32_t Scheduler<N>::pending() {
+    return this->heap.size();
+}
+
+template <unsigned int N>
+uint64_t Scheduler<N>::dueTime(uint32_t start, uint32_t now) {
+    advance(now);
+    return (this->clock + static_cast<int32_t>(start - now));
+}
+
+template <unsigned int N>
+void Scheduler<N>::place(uint32_t index, const Entry& entry) {
+    this->heap[index] = entry;
+    entry.effect->scheduled = index;
+}
+
+template <unsigned int N>
+void Scheduler<N>::siftUp(uint32_t index) {
+    Entry entry = this->heap[index];
+    while (index) {
+        uint32_t parent = ((index - 1) / 2);
+        if (this->heap[parent].due <= entry.due) {
+            break;
+        }
+        place(index, this->heap[parent]);
+        index = parent;
+    }
+    place(index, entry);
+}
+
+template <unsigned int N>
+void Scheduler<N>::siftDown(uint32_t index) {
+    Entry entry = this->heap[index];
+    uint32_t size = this->heap.size();
+    while (true) {
+        uint32_t child = ((index * 2) + 1);
+        if (child >= size) {
+            break;
+        }
+        if (((child + 1) < size) && (this->heap[child + 1].due < this->heap[child].due)) {
+            child++;
+        }
+        if (entry.due <= this->heap[child].due) {
+            break;
+        }
+        place(index, this->heap[child]);
+        index = child;
+    }
+    place(index, entry);
+}
+
+template <unsigned int N>
+bool Scheduler<N>::insert(Effect<N>* effect, uint32_t now) {
+    // O(log n); returns false if the effect is already scheduled
+    if (effect->scheduled >= 0) {
+        return false;
+    }
+    if (this->heap.capacity() < this->capacity) {
+        // Writers that never schedule ahead never pay for the heap
+        this->heap.reserve(this->capacity);
+    }
+    this->heap.push_back({dueTime(effect->start, now), effect});
+    siftUp(this->heap.size() - 1);
+    return true;
+}
+
+template <unsigned int N>
+void Scheduler<N>::remove(Effect<N>* effect) {
+    if (effect->scheduled < 0) {
+        return;
+    }
+    uint32_t index = effect->scheduled;
+    effect->scheduled = -1;
+    Entry moved = this->heap.back();
+    this->heap.pop_back();
+    if (index < this->heap.size()) {
+        place(index, moved);
+        siftUp(index);
+        siftDown(moved.effect->scheduled);
+    }
+}
+
+template <unsigned int N>
+void Scheduler<N>::reschedule(Effect<N>* effect, uint32_t now) {
+    // Re-keys a scheduled effect after its start time changes
+    if (effect->scheduled < 0) {
+        return;
+    }
+    uint32_t index = effect->scheduled;
+    this->heap[index].due = dueTime(effect->start, now);
+    siftUp(index);
+    siftDown(effect->scheduled);
+}
+
+template <unsigned int N>
+Effect<N>* Scheduler<N>::expire(uint32_t now) {
+    // Pops the earliest effect if due; idle cost is a single comparison
+    advance(now);
+    if (this->heap.empty() || (this->heap.front().due > this->clock)) {
+        return nullptr;
+    }
+    Effect<N>* due = this->heap.front().effect;
+    remove(due);
+    return due;
+}
@@ -0,0 +1,65 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <vector>
+#include "Effect.h"
+
+template <unsigned int N=3>
+class Scheduler : public SimpleSerialBase {
+    /* Min-heap of future-dated effects keyed by start time; effects
+    are released to the run queue as they fall due, in start order
+    regardless of insertion order. */
+    public:
+        struct Entry {
+            uint64_t due; // Start time on the extended clock
+            Effect<N>* effect;
+        };
+        std::vector<Entry> heap;
+        uint64_t clock = 0; // Microseconds, extended past 32-bit rollover
+        uint32_t last = 0;
+        size_t capacity; // Reserved on the first insert
+        Scheduler(size_t capacity=0);
+        void advance(uint32_t now);
+        uint32_t pending();
+        bool insert(Effect<N>*, uint32_t now);
+        void remove(Effect<N>*);
+        void reschedule(Effect<N>*, uint32_t now);
+        Effect<N>* expire(uint32_t now);
+    protected:
+        uint64_t dueTime(uint32_t start, uint32_t now);
+        void place(uint32_t index, const Entry&);
+        void siftUp(uint32_t index);
+        void siftDown(uint32_t index);
+};
+
+template class Scheduler<1>;
+template class Scheduler<2>;
+template class Scheduler<3>;
+template class Scheduler<4>;
+template class Scheduler<5>;
+
+#endif
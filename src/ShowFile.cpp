@@ -0,0 +1,416 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "ShowFile.h"
+
+#ifndef IS_EMBEDDED
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <cstdio>
+#endif
+
+uint16_t ShowSource::decode16(const uint8_t* bytes) {
+    return (bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t ShowSource::decode32(const uint8_t* bytes) {
+    return (
+            static_cast<uint32_t>(bytes[0])
+            | (static_cast<uint32_t>(bytes[1]) << 8)
+            | (static_cast<uint32_t>(bytes[2]) << 16)
+            | (static_cast<uint32_t>(bytes[3]) << 24)
+        );
+}
+
+uint64_t ShowSource::decode64(const uint8_t* bytes) {
+    return (static_cast<uint64_t>(decode32(bytes)) | (static_cast<uint64_t>(decode32(bytes + 4)) << 32));
+}
+
+void ShowSource::encode16(std::vector<uint8_t>& bytes, uint16_t value) {
+    bytes.push_back(value & 0xFF);
+    bytes.push_back(value >> 8);
+}
+
+void ShowSource::encode32(std::vector<uint8_t>& bytes, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        bytes.push_back((value >> (i * 8)) & 0xFF);
+    }
+}
+
+void ShowSource::encode64(std::vector<uint8_t>& bytes, uint64_t value) {
+    encode32(bytes, (value & 0xFFFFFFFF));
+    encode32(bytes, (value >> 32));
+}
+
+MemoryShow::MemoryShow(const uint8_t* data, size_t size) {
+    this->data = data;
+    this->size = size;
+}
+
+const uint8_t* MemoryShow::read(size_t length) {
+    if ((this->data == nullptr) || ((this->size - this->offset) < length)) {
+        return nullptr;
+    }
+    const uint8_t* current = (this->data + this->offset);
+    this->offset += length;
+    return current;
+}
+
+bool MemoryShow::rewind() {
+    this->offset = 0;
+    return true;
+}
+
+#ifndef IS_EMBEDDED
+MappedShow::MappedShow(const char* path) {
+    if (path != nullptr) {
+        open(path);
+    }
+}
+
+MappedShow::~MappedShow() {
+    close();
+}
+
+bool MappedShow::open(const char* path) {
+    close();
+    this->descriptor = ::open(path, O_RDONLY);
+    if (this->descriptor < 0) {
+        return false;
+    }
+    struct stat info;
+    if ((fstat(this->descriptor, &info) != 0) || (info.st_size <= 0)) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, this->descriptor, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    // Cues are read once, front to back
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+    this->data = static_cast<const uint8_t*>(mapped);
+    this->size = info.st_size;
+    this->offset = 0;
+    return true;
+}
+
+void MappedShow::close() {
+    if (this->data != nullptr) {
+        munmap(const_cast<uint8_t*>(this->data), this->size);
+        this->data = nullptr;
+    }
+    if (this->descriptor >= 0) {
+        ::close(this->descriptor);
+        this->descriptor = -1;
+    }
+    this->size = 0;
+    this->offset = 0;
+}
+#endif
+
+StreamShow::StreamShow(Reader reader, void* context, Rewinder rewinder) {
+    this->reader = reader;
+    this->context = context;
+    this->rewinder = rewinder;
+}
+
+const uint8_t* StreamShow::read(size_t length) {
+    if (this->buffer.size() < length) {
+        // Grows to the largest record once, then stays flat
+        this->buffer.resize(length);
+    }
+    size_t received = 0;
+    while (received < length) {
+        size_t count = this->reader(this->context, this->buffer.data() + received, length - received);
+        if (!count) {
+            return nullptr;
+        }
+        received += count;
+    }
+    return this->buffer.data();
+}
+
+bool StreamShow::rewind() {
+    return ((this->rewinder != nullptr) && this->rewinder(this->context));
+}
+
+template <unsigned int N>
+ShowRecorder<N>::ShowRecorder() {
+    const char magic[] = "LWSH";
+    this->data.assign(magic, magic + 4);
+    ShowSource::encode16(this->data, SHOW_VERSION);
+    ShowSource::encode16(this->data, N);
+    ShowSource::encode32(this->data, 0); // Cue count, patched as cues are added
+    ShowSource::encode32(this->data, 0);
+}
+
+template <unsigned int N>
+uint8_t ShowRecorder<N>::curve(const Easing* easing) {
+    // Custom Bezier curves are not portable between files and fall back to linear
+    if ((easing == nullptr) || (easing->curve == Easing::BEZIER)) {
+        return SHOW_CURVE_NONE;
+    }
+    return easing->curve;
+}
+
+template <unsigned int N>
+void ShowRecorder<N>::cueHeader(
+        uint8_t type, uint8_t curve, uint16_t keyframes,
+        uint64_t start, uint32_t duration, uint32_t hold,
+        uint32_t uid, int32_t loop, const std::array<uint16_t, N>& target
+    ) {
+    this->data.push_back(type);
+    this->data.push_back(curve);
+    ShowSource::encode16(this->data, keyframes);
+    ShowSource::encode64(this->data, start);
+    ShowSource::encode32(this->data, duration);
+    ShowSource::encode32(this->data, hold);
+    ShowSource::encode32(this->data, uid);
+    ShowSource::encode32(this->data, loop);
+    for (auto value: target) {
+        ShowSource::encode16(this->data, value);
+    }
+    this->cues++;
+    for (int i = 0; i < 4; ++i) {
+        this->data[8 + i] = ((this->cues >> (i * 8)) & 0xFF);
+    }
+}
+
+template <unsigned int N>
+void ShowRecorder<N>::addEffect(
+        std::array<uint16_t, N> target,
+        uint64_t start, uint32_t duration, uint32_t hold,
+        uint32_t uid, int32_t loop, const Easing* easing
+    ) {
+    cueHeader(SHOW_CUE_EFFECT, curve(easing), 0, start, duration, hold, uid, loop, target);
+}
+
+template <unsigned int N>
+void ShowRecorder<N>::addTimeline(
+        const std::vector<Keyframe<N>>& keyframes,
+        uint64_t start, uint32_t uid, int32_t loop
+    ) {
+    std::array<uint16_t, N> target{};
+    uint32_t duration = 0;
+    if (!keyframes.empty()) {
+        target = keyframes.back().color;
+        duration = keyframes.back().time;
+    }
+    cueHeader(
+            SHOW_CUE_TIMELINE, SHOW_CURVE_NONE, keyframes.size(),
+            start, duration, 0, uid, loop, target
+        );
+    for (auto& keyframe: keyframes) {
+        ShowSource::encode32(this->data, keyframe.time);
+        this->data.push_back(curve(keyframe.easing));
+        this->data.push_back(0);
+        for (auto value: keyframe.color) {
+            ShowSource::encode16(this->data, value);
+        }
+    }
+}
+
+template <unsigned int N>
+bool ShowRecorder<N>::save(const char* path) {
+    #ifndef IS_EMBEDDED
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool written = (fwrite(this->data.data(), 1, this->data.size(), file) == this->data.size());
+        return ((fclose(file) == 0) && written);
+    #else
+        return false;
+    #endif
+}
+
+template <unsigned int N>
+ShowPlayer<N>::ShowPlayer(LedWriter<N>* writer, ShowSource* source) {
+    this->writer = writer;
+    this->source = source;
+}
+
+template <unsigned int N>
+bool ShowPlayer<N>::open() {
+    // Reads and checks only the header; cues are decoded during playback
+    this->playing = false;
+    if (!this->source->rewind()) {
+        print("Show source cannot be rewound");
+        return false;
+    }
+    const uint8_t* header = this->source->read(SHOW_HEADER_SIZE);
+    if (
+            (header == nullptr)
+            || (header[0] != 'L') || (header[1] != 'W')
+            || (header[2] != 'S') || (header[3] != 'H')
+        ) {
+        print("Not a show file");
+        return false;
+    }
+    this->version = ShowSource::decode16(header + 4);
+    if (!this->version || (this->version > SHOW_VERSION)) {
+        print("Unsupported show version");
+        return false;
+    }
+    if (ShowSource::decode16(header + 6) != N) {
+        print("Show channel count does not match writer");
+        return false;
+    }
+    this->cues = ShowSource::decode32(header + 8);
+    this->remaining = this->cues;
+    this->waiting = false;
+    return true;
+}
+
+template <unsigned int N>
+void ShowPlayer<N>::play() {
+    // Cue start times are measured from this call
+    this->origin = this->writer->now;
+    this->last = this->origin;
+    this->elapsed = 0;
+    this->playing = true;
+    run();
+}
+
+template <unsigned int N>
+void ShowPlayer<N>::stop() {
+    this->playing = false;
+}
+
+template <unsigned int N>
+const Easing* ShowPlayer<N>::easing(uint8_t curve) {
+    return ((curve <= Easing::EXPONENTIAL_IN_OUT) ? Easing::get(static_cast<Easing::Curve>(curve)) : nullptr);
+}
+
+template <unsigned int N>
+bool ShowPlayer<N>::decode() {
+    /* Reads the next cue's fixed part into next, leaving its keyframes
+    for cue(). Cues of unknown type are read past and not kept. */
+    size_t size = ((this->version < 2) ? SHOW_CUE_SIZE_V1 : SHOW_CUE_SIZE);
+    const uint8_t* record = this->source->read(size + (N * 2));
+    if (record == nullptr) {
+        print("Show ended early");
+        this->remaining = 0;
+        return false;
+    }
+    Cue& cue = this->next;
+    cue.type = record[0];
+    cue.curve = record[1];
+    cue.keyframes = ShowSource::decode16(record + 2);
+    cue.start = ((this->version < 2) ? ShowSource::decode32(record + 4) : ShowSource::decode64(record + 4));
+    // Fields after the start sit 4 bytes earlier in version 1
+    const uint8_t* fields = (record + size - 16);
+    cue.duration = ShowSource::decode32(fields);
+    cue.hold = ShowSource::decode32(fields + 4);
+    cue.uid = ShowSource::decode32(fields + 8);
+    cue.loop = ShowSource::decode32(fields + 12);
+    for (int i = 0; i < N; ++i) {
+        cue.target[i] = ShowSource::decode16(record + size + (i * 2));
+    }
+    this->remaining--;
+    this->waiting = ((cue.type == SHOW_CUE_EFFECT) || (cue.type == SHOW_CUE_TIMELINE));
+    if (!this->waiting) {
+        print("Skipping show cue of unknown type");
+        if (cue.keyframes && (this->source->read(cue.keyframes * (SHOW_KEYFRAME_SIZE + (N * 2))) == nullptr)) {
+            print("Show ended early");
+            this->remaining = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+template <unsigned int N>
+bool ShowPlayer<N>::cue() {
+    // Queues next; false if the show ended early or the writer refused it
+    const Cue& cue = this->next;
+    this->waiting = false;
+    size_t keyframeSize = (SHOW_KEYFRAME_SIZE + (N * 2));
+    const uint8_t* packed = nullptr;
+    if (cue.keyframes) {
+        packed = this->source->read(cue.keyframes * keyframeSize);
+        if (packed == nullptr) {
+            print("Show ended early");
+            this->remaining = 0;
+            return false;
+        }
+    }
+    // Wraps with the writer's clock; the horizon keeps it unambiguous
+    uint32_t start = (this->origin + static_cast<uint32_t>(cue.start));
+    Effect<N>* created;
+    if (cue.type == SHOW_CUE_TIMELINE) {
+        std::vector<Keyframe<N>> keyframes(cue.keyframes);
+        for (uint16_t k = 0; k < cue.keyframes; ++k, packed += keyframeSize) {
+            keyframes[k].time = ShowSource::decode32(packed);
+            keyframes[k].easing = easing(packed[4]);
+            for (int i = 0; i < N; ++i) {
+                keyframes[k].color[i] = ShowSource::decode16(packed + SHOW_KEYFRAME_SIZE + (i * 2));
+            }
+        }
+        created = this->writer->createTimelineAbsolute(std::move(keyframes), start, cue.uid, cue.loop);
+    } else {
+        created = this->writer->createEffectAbsolute(
+                cue.target, (cue.duration * 1e-6), false, start,
+                0, 0, cue.uid, false, cue.loop, easing(cue.curve)
+            );
+    }
+    if ((created != nullptr) && cue.hold) {
+        created->hold(cue.hold * 1e-6, 1);
+    }
+    return (created != nullptr);
+}
+
+template <unsigned int N>
+bool ShowPlayer<N>::run() {
+    /* Tops up the writer's queue from the show; call from loop()
+    before LedWriter::run(). Returns whether cues remain. */
+    if (!this->playing) {
+        return false;
+    }
+    this->elapsed += static_cast<uint32_t>(this->writer->now - this->last);
+    this->last = this->writer->now;
+    while (
+            (this->remaining || this->waiting)
+            && ((this->writer->effectsQueued() + this->writer->effectsScheduled()) < this->lookahead)
+        ) {
+        if (!this->waiting && !decode()) {
+            break;
+        }
+        if (!this->waiting) {
+            // Skipped
+            continue;
+        }
+        if (this->next.start > (this->elapsed + SHOW_HORIZON)) {
+            break;
+        }
+        if (!cue()) {
+            break;
+        }
+    }
+    return (this->remaining || this->waiting);
+}
@@ -0,0 +1,196 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef SHOWFILE_H
+#define SHOWFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "LedWriter.h"
+
+/*
+    Binary show layout, all fields little-endian:
+
+    Header (16 bytes)
+        char[4]     magic "LWSH"
+        uint16_t    version
+        uint16_t    channels
+        uint32_t    cue count
+        uint32_t    reserved
+    Cue (28 bytes + 2 per channel)
+        uint8_t     type; SHOW_CUE_EFFECT or SHOW_CUE_TIMELINE
+        uint8_t     Easing::Curve, or SHOW_CURVE_NONE for linear stepping
+        uint16_t    keyframe count; records following the cue, of any type
+        uint64_t    start, microseconds from show start
+        uint32_t    duration, microseconds
+        uint32_t    hold after fade, microseconds
+        uint32_t    uid
+        int32_t     loop
+        uint16_t[]  target
+    Keyframe (6 bytes + 2 per channel), following a timeline cue
+        uint32_t    time, microseconds from cue start
+        uint8_t     Easing::Curve, or SHOW_CURVE_NONE
+        uint8_t     reserved
+        uint16_t[]  color
+
+    Version 1 cues have a 32-bit start, limiting shows to ~71 minutes;
+    they are still read. Unknown cue types are skipped.
+*/
+
+#define SHOW_VERSION            2
+#define SHOW_HEADER_SIZE        16
+#define SHOW_CUE_SIZE           28
+#define SHOW_CUE_SIZE_V1        24
+#define SHOW_KEYFRAME_SIZE      6
+#define SHOW_CUE_EFFECT         0
+#define SHOW_CUE_TIMELINE       1
+#define SHOW_CURVE_NONE         0xFF
+#define SHOW_LOOKAHEAD          16
+#define SHOW_HORIZON            600000000 // Microseconds; later cues wait in the player, within the writer's clock range
+
+class ShowSource {
+    /* Sequential reader over show bytes. read() returns a pointer to the
+    next length bytes, valid until the next call, or null past the end. */
+    public:
+        virtual ~ShowSource() {}
+        virtual const uint8_t* read(size_t length) = 0;
+        virtual bool rewind() = 0;
+        static uint16_t decode16(const uint8_t*);
+        static uint32_t decode32(const uint8_t*);
+        static uint64_t decode64(const uint8_t*);
+        static void encode16(std::vector<uint8_t>&, uint16_t);
+        static void encode32(std::vector<uint8_t>&, uint32_t);
+        static void encode64(std::vector<uint8_t>&, uint64_t);
+};
+
+class MemoryShow : public ShowSource {
+    // Reads directly from bytes already in memory or flash; no copies
+    public:
+        const uint8_t* data;
+        size_t size, offset = 0;
+        MemoryShow(const uint8_t* data=nullptr, size_t size=0);
+        const uint8_t* read(size_t length) override;
+        bool rewind() override;
+};
+
+#ifndef IS_EMBEDDED
+class MappedShow : public MemoryShow {
+    // Memory-maps a show file; pages load on demand as cues are read
+    public:
+        int descriptor = -1;
+        MappedShow(const char* path=nullptr);
+        ~MappedShow();
+        bool open(const char* path);
+        void close();
+};
+#endif
+
+class StreamShow : public ShowSource {
+    /* Pulls bytes through a callback, e.g. wrapping File::read() on
+    flash; holds one record at a time in a reusable buffer. */
+    public:
+        typedef size_t (*Reader)(void* context, uint8_t* buffer, size_t length);
+        typedef bool (*Rewinder)(void* context);
+        Reader reader;
+        Rewinder rewinder;
+        void* context;
+        std::vector<uint8_t> buffer;
+        StreamShow(Reader reader, void* context, Rewinder rewinder=nullptr);
+        const uint8_t* read(size_t length) override;
+        bool rewind() override;
+};
+
+template <unsigned int N=3>
+class ShowRecorder {
+    // Serializes cues into the binary show layout
+    public:
+        std::vector<uint8_t> data;
+        uint32_t cues = 0;
+        ShowRecorder();
+        void addEffect(
+                std::array<uint16_t, N> target,
+                uint64_t start, uint32_t duration, uint32_t hold=0,
+                uint32_t uid=0, int32_t loop=0, const Easing* easing=nullptr
+            );
+        void addTimeline(
+                const std::vector<Keyframe<N>>& keyframes,
+                uint64_t start, uint32_t uid=0, int32_t loop=0
+            );
+        static uint8_t curve(const Easing*);
+        bool save(const char* path);
+    protected:
+        void cueHeader(
+                uint8_t type, uint8_t curve, uint16_t keyframes,
+                uint64_t start, uint32_t duration, uint32_t hold,
+                uint32_t uid, int32_t loop, const std::array<uint16_t, N>& target
+            );
+};
+
+template <unsigned int N=3>
+class ShowPlayer : public SimpleSerialBase {
+    /* Streams cues from a source into a writer, decoding each only
+    when the writer's queue drops below the look-ahead depth. Show time
+    is kept on a 64-bit clock; a cue more than SHOW_HORIZON ahead waits
+    here, decoded, until the writer's 32-bit clock can place it. */
+    public:
+        struct Cue {
+            uint8_t type, curve;
+            uint16_t keyframes;
+            uint64_t start; // From show start
+            uint32_t duration, hold, uid;
+            int32_t loop;
+            std::array<uint16_t, N> target;
+        };
+        LedWriter<N>* writer;
+        ShowSource* source;
+        uint32_t cues = 0, remaining = 0, origin = 0, last = 0, lookahead = SHOW_LOOKAHEAD;
+        uint64_t elapsed = 0; // Show time at the last run()
+        uint16_t version = SHOW_VERSION;
+        Cue next;
+        bool playing = false, waiting = false;
+        ShowPlayer(LedWriter<N>* writer, ShowSource* source);
+        bool open();
+        void play();
+        void stop();
+        bool run();
+        static const Easing* easing(uint8_t);
+    protected:
+        bool decode();
+        bool cue();
+};
+
+template class ShowRecorder<1>;
+template class ShowRecorder<2>;
+template class ShowRecorder<3>;
+template class ShowRecorder<4>;
+template class ShowRecorder<5>;
+
+template class ShowPlayer<1>;
+template class ShowPlayer<2>;
+template class ShowPlayer<3>;
+template class ShowPlayer<4>;
+template class ShowPlayer<5>;
+
+#endif
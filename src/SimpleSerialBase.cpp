@@ -25,6 +25,20 @@
 #include "SimpleSerialBase.h"
 #include <cmath>
 
+#ifndef IS_EMBEDDED
+    #include <cstdarg>
+
+    HostSerial Serial;
+
+    int HostSerial::printf(const char* format, ...) {
+        va_list arguments;
+        va_start(arguments, format);
+        int written = std::vprintf(format, arguments);
+        va_end(arguments);
+        return written;
+    }
+#endif
+
 bool SimpleSerialBase::staticVerbose = false;
 
 template <typename T>
@@ -30,6 +30,13 @@
     #define IS_EMBEDDED     true
 #else
     #include <iostream>
+    #include <cstdio>
+    class HostSerial {
+        // Stand-in for the Arduino Serial object on host builds
+        public:
+            int printf(const char* format, ...);
+    };
+    extern HostSerial Serial;
 #endif
 #include <string>
 #include <sstream>
@@ -0,0 +1,290 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Timecode.h"
+#include "ClockSync.h"
+
+#if !defined(IS_EMBEDDED)
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+static const uint8_t nominalRates[4] = {24, 25, 30, 30};
+
+uint64_t Timecode::toMicroseconds() const {
+    /* Drop-frame skips frame numbers 0 and 1 each minute except every
+    tenth. Rounds up, so converting back lands on the same frame. */
+    uint8_t fps = nominalRates[this->rate & 3];
+    uint32_t totalMinutes = ((this->hours * 60) + this->minutes);
+    uint64_t count = (((static_cast<uint64_t>(totalMinutes) * 60) + this->seconds) * fps) + this->frames;
+    if (this->rate == FPS_2997_DROP) {
+        count -= (2 * (totalMinutes - (totalMinutes / 10)));
+        return (((count * 1001000) + 29) / 30);
+    }
+    return (((count * 1000000) + fps - 1) / fps);
+}
+
+Timecode Timecode::fromMicroseconds(uint64_t time, uint8_t rate) {
+    Timecode timecode;
+    timecode.rate = (rate & 3);
+    uint8_t fps = nominalRates[timecode.rate];
+    uint64_t count;
+    if (timecode.rate == FPS_2997_DROP) {
+        // Back to frame numbers: 17982 frames per ten minutes, 1798 per dropped minute
+        count = ((time * 30) / 1001000);
+        uint64_t tens = (count / 17982), remainder = (count % 17982);
+        count += ((18 * tens) + ((remainder > 1) ? (2 * ((remainder - 2) / 1798)) : 0));
+    } else {
+        count = ((time * fps) / 1000000);
+    }
+    timecode.frames = (count % fps);
+    count /= fps;
+    timecode.seconds = (count % 60);
+    count /= 60;
+    timecode.minutes = (count % 60);
+    timecode.hours = ((count / 60) % 24);
+    return timecode;
+}
+
+uint32_t Timecode::frameLength(uint8_t rate) {
+    return (((rate & 3) == FPS_2997_DROP) ? 33367 : (1000000 / nominalRates[rate & 3]));
+}
+
+uint8_t Timecode::quarterFrame(const Timecode& timecode, uint8_t piece) {
+    // Data byte following MTC_QUARTER_FRAME for one of eight pieces
+    uint8_t values[8] = {
+            static_cast<uint8_t>(timecode.frames & 0xF), static_cast<uint8_t>(timecode.frames >> 4),
+            static_cast<uint8_t>(timecode.seconds & 0xF), static_cast<uint8_t>(timecode.seconds >> 4),
+            static_cast<uint8_t>(timecode.minutes & 0xF), static_cast<uint8_t>(timecode.minutes >> 4),
+            static_cast<uint8_t>(timecode.hours & 0xF),
+            static_cast<uint8_t>(((timecode.rate & 3) << 1) | (timecode.hours >> 4))
+        };
+    return (((piece & 7) << 4) | values[piece & 7]);
+}
+
+size_t Timecode::fullFrame(uint8_t* message, const Timecode& timecode) {
+    const uint8_t bytes[MTC_FULL_FRAME_SIZE] = {
+            0xF0, 0x7F, 0x7F, 0x01, 0x01,
+            static_cast<uint8_t>(((timecode.rate & 3) << 5) | (timecode.hours & 0x1F)),
+            timecode.minutes, timecode.seconds, timecode.frames, 0xF7
+        };
+    for (size_t i = 0; i < MTC_FULL_FRAME_SIZE; ++i) {
+        message[i] = bytes[i];
+    }
+    return MTC_FULL_FRAME_SIZE;
+}
+
+TimecodeReceiver::TimecodeReceiver(LocalClock local) {
+    this->local = ((local != nullptr) ? local : ClockSync::localMicros);
+}
+
+TimecodeReceiver::~TimecodeReceiver() {
+    end();
+}
+
+bool TimecodeReceiver::begin(uint16_t port) {
+    this->port = port;
+    #if ESP32
+        return this->udp.begin(port);
+    #elif !defined(IS_EMBEDDED)
+        end();
+        this->descriptor = socket(AF_INET, SOCK_DGRAM, 0);
+        if (this->descriptor < 0) {
+            print("Unable to open socket");
+            return false;
+        }
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(this->descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            print("Unable to bind socket");
+            end();
+            return false;
+        }
+        fcntl(this->descriptor, F_SETFL, (fcntl(this->descriptor, F_GETFL) | O_NONBLOCK));
+        this->owned = true;
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+#if !defined(IS_EMBEDDED)
+void TimecodeReceiver::attach(int descriptor) {
+    // Reads MIDI bytes from a pipe, FIFO or MIDI device; not closed by end()
+    end();
+    this->descriptor = descriptor;
+    this->owned = false;
+    fcntl(descriptor, F_SETFL, (fcntl(descriptor, F_GETFL) | O_NONBLOCK));
+}
+#endif
+
+void TimecodeReceiver::end() {
+    #if ESP32
+        this->udp.stop();
+    #elif !defined(IS_EMBEDDED)
+        if ((this->descriptor >= 0) && this->owned) {
+            close(this->descriptor);
+        }
+        this->descriptor = -1;
+        this->owned = false;
+    #endif
+}
+
+uint32_t TimecodeReceiver::run() {
+    // Drains everything waiting; returns the number of timecode updates
+    uint32_t before = this->messages;
+    uint8_t buffer[256];
+    #if ESP32
+        for (int size; (size = this->udp.parsePacket()) > 0;) {
+            uint64_t arrival = this->local();
+            size = this->udp.read(buffer, sizeof(buffer));
+            feed(buffer, size, arrival);
+        }
+    #elif !defined(IS_EMBEDDED)
+        if (this->descriptor < 0) {
+            return 0;
+        }
+        for (ssize_t size; (size = read(this->descriptor, buffer, sizeof(buffer))) > 0;) {
+            feed(buffer, size, this->local());
+        }
+    #endif
+    return (this->messages - before);
+}
+
+void TimecodeReceiver::feed(const uint8_t* bytes, size_t size, uint64_t arrival) {
+    /* Byte-wise MIDI parser, so messages may be split across reads.
+    Real-time bytes may appear anywhere and are skipped. */
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t byte = bytes[i];
+        if (byte >= 0xF8) {
+            continue;
+        } else if (this->collecting) {
+            if (this->sysexLength < MTC_FULL_FRAME_SIZE) {
+                this->sysex[this->sysexLength++] = byte;
+            }
+            if (byte == 0xF7) {
+                this->collecting = false;
+                const uint8_t* m = this->sysex;
+                if (
+                        (this->sysexLength == MTC_FULL_FRAME_SIZE)
+                        && (m[1] == 0x7F) && (m[3] == 0x01) && (m[4] == 0x01)
+                    ) {
+                    Timecode timecode;
+                    timecode.rate = ((m[5] >> 5) & 3);
+                    timecode.hours = (m[5] & 0x1F);
+                    timecode.minutes = m[6];
+                    timecode.seconds = m[7];
+                    timecode.frames = m[8];
+                    this->rate = timecode.rate;
+                    this->received = 0;
+                    this->lastPiece = -1;
+                    sync(timecode.toMicroseconds(), arrival, false);
+                }
+            } else if (byte & 0x80) {
+                // Another status byte interrupted the message
+                this->collecting = false;
+            }
+            if (this->collecting || (byte != 0xF0)) {
+                continue;
+            }
+        }
+        if (byte == 0xF0) {
+            this->collecting = true;
+            this->sysex[0] = byte;
+            this->sysexLength = 1;
+            this->quarter = false;
+        } else if (byte & 0x80) {
+            this->quarter = (byte == MTC_QUARTER_FRAME);
+        } else if (this->quarter) {
+            this->quarter = false;
+            uint8_t piece = (byte >> 4);
+            if ((piece != 0) && (piece != (this->lastPiece + 1))) {
+                // Out of order or running backward; wait for the next piece 0
+                this->received = 0;
+            }
+            this->lastPiece = piece;
+            this->pieces[piece & 7] = (byte & 0xF);
+            this->received = ((piece == 0) ? 1 : (this->received | (1 << piece)));
+            if ((piece == 7) && (this->received == 0xFF)) {
+                Timecode timecode;
+                timecode.frames = (this->pieces[0] | ((this->pieces[1] & 1) << 4));
+                timecode.seconds = (this->pieces[2] | ((this->pieces[3] & 3) << 4));
+                timecode.minutes = (this->pieces[4] | ((this->pieces[5] & 3) << 4));
+                timecode.hours = (this->pieces[6] | ((this->pieces[7] & 1) << 4));
+                timecode.rate = ((this->pieces[7] >> 1) & 3);
+                this->rate = timecode.rate;
+                this->received = 0;
+                // Piece 0 marked the frame; piece 7 arrives seven quarter frames later
+                sync((timecode.toMicroseconds() + ((Timecode::frameLength(timecode.rate) * 7) / 4)), arrival, true);
+            }
+        }
+    }
+}
+
+void TimecodeReceiver::sync(uint64_t time, uint64_t arrival, bool running) {
+    int64_t error = (static_cast<int64_t>(time) - static_cast<int64_t>(this->time(arrival)));
+    int64_t tolerance = (2 * Timecode::frameLength(this->rate));
+    if (!this->locked || !running || !this->running || (error > tolerance) || (error < -tolerance)) {
+        // Locate, start or jump; show time may move backward
+        this->seeks += (this->locked && ((error > tolerance) || (error < -tolerance)));
+        this->reported = time;
+    }
+    this->anchorTime = time;
+    this->anchorLocal = arrival;
+    this->lastReceived = arrival;
+    this->running = running;
+    this->locked = true;
+    this->messages++;
+}
+
+uint64_t TimecodeReceiver::time() {
+    return time(this->local());
+}
+
+uint64_t TimecodeReceiver::time(uint64_t local) {
+    /* Show time at a local reading. While running, never steps back
+    for arrival jitter; only a locate or a jump can move it backward. */
+    if (!this->running) {
+        return this->anchorTime;
+    }
+    if ((local - this->lastReceived) > this->freewheel) {
+        // Timecode stopped; settle on the last position actually received
+        this->anchorTime += (this->lastReceived - this->anchorLocal);
+        this->anchorLocal = this->lastReceived;
+        this->running = false;
+        this->reported = this->anchorTime;
+        this->dropouts++;
+        return this->anchorTime;
+    }
+    uint64_t current = (this->anchorTime + (local - this->anchorLocal));
+    if (current > this->reported) {
+        this->reported = current;
+    }
+    return this->reported;
+}
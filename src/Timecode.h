@@ -0,0 +1,102 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef TIMECODE_H
+#define TIMECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SimpleSerialBase.h"
+
+#if ESP32
+    #include <WiFiUdp.h>
+#endif
+
+#define TIMECODE_PORT           5004
+#define TIMECODE_FREEWHEEL      500000 // Microseconds to keep running through a dropout
+#define MTC_FULL_FRAME_SIZE     10
+#define MTC_QUARTER_FRAME       0xF1
+
+/*
+    MIDI timecode messages accepted from any byte stream:
+
+    Quarter frame (2 bytes), eight per two frames while running
+        0xF1, piece << 4 | nibble
+        pieces 0 - 7: frames low/high, seconds low/high, minutes
+        low/high, hours low, rate << 1 | hours high
+    Full frame (10 bytes), sent on locate while stopped
+        0xF0 0x7F device 0x01 0x01 rate << 5 | hours, minutes, seconds, frames, 0xF7
+
+    Over UDP, each datagram carries one or more whole messages.
+*/
+
+struct Timecode {
+    enum Rate : uint8_t {FPS_24, FPS_25, FPS_2997_DROP, FPS_30};
+    uint8_t hours = 0, minutes = 0, seconds = 0, frames = 0, rate = FPS_30;
+    uint64_t toMicroseconds() const;
+    static Timecode fromMicroseconds(uint64_t time, uint8_t rate=FPS_30);
+    static uint32_t frameLength(uint8_t rate);
+    static uint8_t quarterFrame(const Timecode& timecode, uint8_t piece);
+    static size_t fullFrame(uint8_t* message, const Timecode& timecode);
+};
+
+class TimecodeReceiver : public SimpleSerialBase {
+    /* Follows an external show clock. Each complete set of quarter
+    frames, or a full frame on locate, anchors show time to the local
+    clock; between messages, time runs on from the last anchor. When
+    running timecode stops arriving, time freewheels for a while before
+    stopping at the last received position. */
+    public:
+        typedef uint64_t (*LocalClock)();
+        LocalClock local;
+        uint64_t anchorTime = 0, anchorLocal = 0, lastReceived = 0, reported = 0;
+        uint32_t freewheel = TIMECODE_FREEWHEEL, messages = 0, seeks = 0, dropouts = 0;
+        uint16_t port = 0;
+        uint8_t rate = Timecode::FPS_30;
+        bool running = false, locked = false;
+        TimecodeReceiver(LocalClock local=nullptr);
+        ~TimecodeReceiver();
+        bool begin(uint16_t port=TIMECODE_PORT);
+        #if !defined(IS_EMBEDDED)
+            void attach(int descriptor);
+        #endif
+        void end();
+        uint32_t run();
+        void feed(const uint8_t* bytes, size_t size, uint64_t arrival);
+        uint64_t time();
+        uint64_t time(uint64_t local);
+    protected:
+        uint8_t pieces[8], received = 0, sysex[MTC_FULL_FRAME_SIZE], sysexLength = 0;
+        int8_t lastPiece = -1;
+        bool quarter = false, collecting = false;
+        void sync(uint64_t time, uint64_t arrival, bool running);
+        #if ESP32
+            WiFiUDP udp;
+        #elif !defined(IS_EMBEDDED)
+            int descriptor = -1;
+            bool owned = false;
+        #endif
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "TimecodeChase.h"
+#include <algorithm>
+
+template <unsigned int N>
+TimecodeChase<N>::TimecodeChase(LedWriter<N>* writer, TimecodeReceiver* source) {
+    this->writer = writer;
+    this->source = source;
+    for (int i = 0; i < N; ++i) {
+        this->base[i] = writer->channels[i]->get();
+    }
+    this->output = this->base;
+}
+
+template <unsigned int N>
+TimecodeChase<N>::~TimecodeChase() {
+    clear();
+}
+
+template <unsigned int N>
+Timeline<N>* TimecodeChase<N>::addTimeline(
+        std::vector<Keyframe<N>> keyframes, double start, int32_t loop
+    ) {
+    Timeline<N>* timeline = new Timeline<N>(
+            std::move(keyframes), &this->writer->channels, &this->writer->now
+        );
+    insert({timeline, static_cast<uint64_t>(start * 1e6), timeline->duration, loop, {}});
+    return timeline;
+}
+
+template <unsigned int N>
+Generator<N>* TimecodeChase<N>::addGenerator(
+        std::array<Oscillator, N> oscillators, double start, double length
+    ) {
+    Generator<N>* generator = new Generator<N>(
+            oscillators, &this->writer->channels, &this->writer->now
+        );
+    insert({generator, static_cast<uint64_t>(start * 1e6), static_cast<uint32_t>(length * 1e6), 0, {}});
+    return generator;
+}
+
+template <unsigned int N>
+void TimecodeChase<N>::insert(ChaseCue<N> cue) {
+    /* Keeps cues ordered by start and re-derives every origin, since
+    each cue begins from wherever the one before it was cut off. */
+    auto position = std::upper_bound(
+            this->cues.begin(), this->cues.end(), cue.start,
+            [](uint64_t start, const ChaseCue<N>& other) {
+                return (start < other.start);
+            }
+        );
+    this->cues.insert(position, cue);
+    for (size_t i = 0; i < this->cues.size(); ++i) {
+        if (!i) {
+            this->cues[i].origin = this->base;
+        } else {
+            const ChaseCue<N>& previous = this->cues[i - 1];
+            this->cues[i].origin = evaluate(previous, (this->cues[i].start - previous.start));
+        }
+    }
+    this->written = false;
+}
+
+template <unsigned int N>
+void TimecodeChase<N>::clear() {
+    for (auto& cue: this->cues) {
+        delete cue.effect;
+    }
+    this->cues.clear();
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> TimecodeChase<N>::evaluate(const ChaseCue<N>& cue, uint64_t offset) {
+    // Loops restart from the target their previous pass ended on
+    if (!cue.length) {
+        return cue.effect->evaluate(static_cast<uint32_t>(offset), cue.origin);
+    }
+    uint64_t pass = (offset / cue.length);
+    uint32_t position = (offset % cue.length);
+    if ((cue.loop >= 0) && (pass > static_cast<uint64_t>(cue.loop))) {
+        pass = cue.loop;
+        position = cue.length;
+    }
+    return cue.effect->evaluate(position, (pass ? cue.effect->target : cue.origin));
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> TimecodeChase<N>::evaluate(uint64_t time) {
+    auto next = std::upper_bound(
+            this->cues.begin(), this->cues.end(), time,
+            [](uint64_t value, const ChaseCue<N>& cue) {
+                return (value < cue.start);
+            }
+        );
+    if (next == this->cues.begin()) {
+        return this->base;
+    }
+    const ChaseCue<N>& cue = *(next - 1);
+    return evaluate(cue, (time - cue.start));
+}
+
+template <unsigned int N>
+bool TimecodeChase<N>::seek(uint64_t time) {
+    // Writes the state at time; only changed channels are touched
+    this->position = time;
+    std::array<uint16_t, N> values = evaluate(time);
+    bool changed = !this->written;
+    for (int i = 0; i < N; ++i) {
+        if (!this->written || (values[i] != this->output[i])) {
+            this->writer->channels[i]->overwrite(values[i]);
+            changed = true;
+        }
+    }
+    this->output = values;
+    this->written = true;
+    return changed;
+}
+
+template <unsigned int N>
+bool TimecodeChase<N>::run() {
+    /* Call as often as the writer would be run. Until the source has
+    locked, output is left alone. */
+    if (this->source == nullptr) {
+        return false;
+    }
+    this->source->run();
+    if (!this->source->locked) {
+        return false;
+    }
+    return seek(this->source->time());
+}
@@ -0,0 +1,76 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef TIMECODECHASE_H
+#define TIMECODECHASE_H
+
+#include <stdint.h>
+#include <vector>
+#include "LedWriter.h"
+#include "Timecode.h"
+
+template <unsigned int N=3>
+struct ChaseCue {
+    Effect<N>* effect; // Analytic: a Timeline or Generator
+    uint64_t start; // Microseconds of show time
+    uint32_t length; // One pass in microseconds; 0 runs until the next cue
+    int32_t loop; // Further passes; -1 repeats until the next cue
+    std::array<uint16_t, N> origin; // Output when the cue begins
+};
+
+template <unsigned int N=3>
+class TimecodeChase : public SimpleSerialBase {
+    /* Drives a writer from external show time instead of its own clock.
+    Output is evaluated in closed form from the cue list at whatever
+    time the source reports, so a locate or scrub lands directly on the
+    right state in O(log cues + log keyframes) without replaying the
+    show. The writer's own queue should be left empty while chasing. */
+    public:
+        LedWriter<N>* writer;
+        TimecodeReceiver* source;
+        std::vector<ChaseCue<N>> cues;
+        std::array<uint16_t, N> base; // Output before the first cue
+        std::array<uint16_t, N> output;
+        uint64_t position = 0;
+        bool written = false;
+        TimecodeChase(LedWriter<N>* writer, TimecodeReceiver* source=nullptr);
+        ~TimecodeChase();
+        Timeline<N>* addTimeline(std::vector<Keyframe<N>> keyframes, double start, int32_t loop=0);
+        Generator<N>* addGenerator(std::array<Oscillator, N> oscillators, double start, double length=0);
+        void clear();
+        std::array<uint16_t, N> evaluate(uint64_t time);
+        bool seek(uint64_t time);
+        bool run();
+    protected:
+        void insert(ChaseCue<N> cue);
+        std::array<uint16_t, N> evaluate(const ChaseCue<N>& cue, uint64_t offset);
+};
+
+template class TimecodeChase<1>;
+template class TimecodeChase<2>;
+template class TimecodeChase<3>;
+template class TimecodeChase<4>;
+template class TimecodeChase<5>;
+
+#endif
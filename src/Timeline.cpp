@@ -0,0 +1,103 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Timeline.h"
+#include <algorithm>
+
+template <unsigned int N>
+Timeline<N>::Timeline(
+        std::vector<Keyframe<N>> keyframes,
+        std::array<ColorChannel*, N>* channels,
+        uint32_t* now,
+        uint32_t absoluteStart,
+        uint32_t uid,
+        int32_t loop
+    ) : Effect<N>(
+            (keyframes.empty() ? std::array<uint16_t, N>{} : keyframes.back().color),
+            channels, now, 0, false, absoluteStart, 0, 0, uid, loop
+        ) {
+    this->keyframes = std::move(keyframes);
+    std::stable_sort(
+            this->keyframes.begin(), this->keyframes.end(),
+            [](const Keyframe<N>& first, const Keyframe<N>& second) {
+                return (first.time < second.time);
+            }
+        );
+    for (auto& keyframe: this->keyframes) {
+        for (int i = 0; i < N; ++i) {
+            keyframe.color[i] = (*this->channels)[i]->conform(keyframe.color[i]);
+        }
+    }
+    if (!this->keyframes.empty()) {
+        // Total length is set by the last keyframe, not rounded through seconds
+        this->target = this->keyframes.back().color;
+        this->duration = (this->keyframes.back().time ? this->keyframes.back().time : 1);
+        this->end = (this->start + this->duration);
+        this->defer();
+    }
+}
+
+template <unsigned int N>
+bool Timeline<N>::analytic() {
+    return true;
+}
+
+template <unsigned int N>
+size_t Timeline<N>::segment(uint32_t position) {
+    // Index of the first keyframe after position; O(log k)
+    return (std::upper_bound(
+            this->keyframes.begin(), this->keyframes.end(), position,
+            [](uint32_t value, const Keyframe<N>& keyframe) {
+                return (value < keyframe.time);
+            }
+        ) - this->keyframes.begin());
+}
+
+template <unsigned int N>
+std::array<uint16_t, N> Timeline<N>::evaluate(
+        uint32_t position, const std::array<uint16_t, N>& from
+    ) {
+    size_t index = segment(position);
+    if (index >= this->keyframes.size()) {
+        return this->target;
+    }
+    // Interpolate from the previous keyframe, or the origin before the first
+    const Keyframe<N>& next = this->keyframes[index];
+    const std::array<uint16_t, N>& previous = (
+            index ? this->keyframes[index - 1].color : from
+        );
+    uint32_t previousTime = (index ? this->keyframes[index - 1].time : 0);
+    const Easing* curve = (
+            next.easing != nullptr ? next.easing : Easing::get(Easing::LINEAR)
+        );
+    uint16_t progress = Easing::progress(position - previousTime, next.time - previousTime);
+    std::array<uint16_t, N> values;
+    for (int i = 0; i < N; ++i) {
+        values[i] = (
+                this->drives(i)
+                ? curve->interpolate(previous[i], next.color[i], progress) : from[i]
+            );
+    }
+    return values;
+}
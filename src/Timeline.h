@@ -0,0 +1,63 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <vector>
+#include "Effect.h"
+
+template <unsigned int N=3>
+struct Keyframe {
+    uint32_t time; // Microseconds from timeline start
+    std::array<uint16_t, N> color;
+    const Easing* easing; // Curve into this keyframe; linear if null
+};
+
+template <unsigned int N=3>
+class Timeline : public Effect<N> {
+    public:
+        std::vector<Keyframe<N>> keyframes;
+        Timeline(
+                std::vector<Keyframe<N>> keyframes,
+                std::array<ColorChannel*, N>* channels,
+                uint32_t* now,
+                uint32_t absoluteStart=0,
+                uint32_t uid=0,
+                int32_t loop=0
+            );
+        bool analytic() override;
+        std::array<uint16_t, N> evaluate(
+                uint32_t position, const std::array<uint16_t, N>& from
+            ) override;
+        size_t segment(uint32_t position);
+};
+
+template class Timeline<1>;
+template class Timeline<2>;
+template class Timeline<3>;
+template class Timeline<4>;
+template class Timeline<5>;
+
+#endif
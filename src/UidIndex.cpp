@@ -0,0 +1,189 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "UidIndex.h"
+
+template <unsigned int N>
+UidIndex<N>::~UidIndex() {
+    delete[] this->slots;
+    this->slots = nullptr;
+}
+
+template <unsigned int N>
+uint32_t UidIndex<N>::home(uint32_t uid) {
+    // Fibonacci hashing spreads sequential UIDs across the table
+    return ((uid * 2654435769u) >> (32 - this->bits));
+}
+
+template <unsigned int N>
+uint32_t UidIndex<N>::locate(uint32_t uid) {
+    // Slot holding uid, or the empty slot where it would be placed
+    uint32_t index = home(uid);
+    while (
+            (this->slots[index].head != nullptr)
+            && (this->slots[index].uid != uid)
+        ) {
+        index = ((index + 1) & ((1u << this->bits) - 1));
+    }
+    return index;
+}
+
+template <unsigned int N>
+bool UidIndex<N>::grow() {
+    // Doubles the table and rehashes; chains move with their heads
+    uint32_t grown = (this->bits ? (this->bits + 1) : UID_INDEX_MIN_BITS);
+    if (grown > UID_INDEX_MAX_BITS) {
+        return false;
+    }
+    Slot* previous = this->slots;
+    uint32_t previousSize = (this->bits ? (1u << this->bits) : 0);
+    this->slots = new (std::nothrow) Slot[1u << grown];
+    if (this->slots == nullptr) {
+        this->slots = previous;
+        return false;
+    }
+    this->bits = grown;
+    for (uint32_t i = 0; i < previousSize; ++i) {
+        if (previous[i].head != nullptr) {
+            this->slots[locate(previous[i].uid)] = previous[i];
+        }
+    }
+    delete[] previous;
+    return true;
+}
+
+template <unsigned int N>
+bool UidIndex<N>::insert(Effect<N>* effect) {
+    if (this->overflowed) {
+        return false;
+    }
+    if (((this->occupied + 1) * 2) > (this->bits ? (1u << this->bits) : 0)) {
+        // Only a new UID can need room, and requeued loops free theirs first
+        if ((find(effect->uid) == nullptr) && !grow()) {
+            print("UID index full; finding UIDs by scanning until the queue drains");
+            clear();
+            this->overflowed = true;
+            return false;
+        }
+    }
+    uint32_t index = locate(effect->uid);
+    Slot& slot = this->slots[index];
+    if (slot.head == nullptr) {
+        slot.uid = effect->uid;
+        this->occupied++;
+    } else {
+        slot.head->uidPrevious = effect;
+    }
+    effect->uidPrevious = nullptr;
+    effect->uidNext = slot.head;
+    slot.head = effect;
+    return true;
+}
+
+template <unsigned int N>
+void UidIndex<N>::remove(Effect<N>* effect) {
+    if (this->overflowed || !this->bits) {
+        // Chains, if any, are the owner's scan results
+        effect->uidPrevious = nullptr;
+        effect->uidNext = nullptr;
+        return;
+    }
+    if (effect->uidPrevious != nullptr) {
+        // Mid-chain; unlink without touching the table
+        effect->uidPrevious->uidNext = effect->uidNext;
+        if (effect->uidNext != nullptr) {
+            effect->uidNext->uidPrevious = effect->uidPrevious;
+        }
+    } else {
+        uint32_t index = locate(effect->uid);
+        Slot& slot = this->slots[index];
+        if (slot.head != effect) {
+            // Not indexed
+            return;
+        }
+        slot.head = effect->uidNext;
+        if (slot.head != nullptr) {
+            slot.head->uidPrevious = nullptr;
+        } else {
+            vacate(index);
+        }
+    }
+    effect->uidPrevious = nullptr;
+    effect->uidNext = nullptr;
+}
+
+template <unsigned int N>
+void UidIndex<N>::vacate(uint32_t index) {
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    uint32_t hole = index, next = index;
+    while (true) {
+        next = ((next + 1) & ((1u << this->bits) - 1));
+        if (this->slots[next].head == nullptr) {
+            break;
+        }
+        uint32_t natural = home(this->slots[next].uid);
+        bool reachable = (
+                (hole <= next)
+                ? ((hole < natural) && (natural <= next))
+                : ((hole < natural) || (natural <= next))
+            );
+        if (!reachable) {
+            this->slots[hole] = this->slots[next];
+            hole = next;
+        }
+    }
+    this->slots[hole].head = nullptr;
+    this->occupied--;
+}
+
+template <unsigned int N>
+Effect<N>* UidIndex<N>::find(uint32_t uid) {
+    // Newest effect with uid, as insert() links at the head; uidNext walks to older ones
+    if (!this->bits) {
+        return nullptr;
+    }
+    return this->slots[locate(uid)].head;
+}
+
+template <unsigned int N>
+void UidIndex<N>::clear() {
+    uint32_t size = (this->bits ? (1u << this->bits) : 0);
+    for (uint32_t i = 0; i < size; ++i) {
+        Slot& slot = this->slots[i];
+        for (Effect<N>* effect = slot.head; effect != nullptr;) {
+            Effect<N>* next = effect->uidNext;
+            effect->uidPrevious = nullptr;
+            effect->uidNext = nullptr;
+            effect = next;
+        }
+        slot.head = nullptr;
+    }
+    this->occupied = 0;
+}
+
+template <unsigned int N>
+void UidIndex<N>::reset() {
+    // Owner's queue is empty, so the index is complete again
+    this->overflowed = false;
+}
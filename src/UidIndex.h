@@ -0,0 +1,68 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef UIDINDEX_H
+#define UIDINDEX_H
+
+#include <new>
+#include "Effect.h"
+
+#define UID_INDEX_MIN_BITS  4
+#define UID_INDEX_MAX_BITS  16 // Enough for MAX_EFFECTS at half load many times over
+
+template <unsigned int N=3>
+class UidIndex : public SimpleSerialBase {
+    /* Open-addressed table mapping each UID to a chain of effects
+    sharing it; chains are linked through the effects themselves. The
+    table is allocated on first insert and doubles to stay at most half
+    full. If it cannot grow it empties and reports overflowed, and the
+    owner looks UIDs up by scanning until its queue drains. */
+    public:
+        struct Slot {
+            uint32_t uid = 0;
+            Effect<N>* head = nullptr; // Empty when null
+        };
+        Slot* slots = nullptr;
+        uint32_t bits = 0, occupied = 0;
+        bool overflowed = false;
+        ~UidIndex();
+        bool insert(Effect<N>*);
+        void remove(Effect<N>*);
+        Effect<N>* find(uint32_t uid);
+        void clear();
+        void reset();
+    protected:
+        uint32_t home(uint32_t uid);
+        uint32_t locate(uint32_t uid);
+        bool grow();
+        void vacate(uint32_t index);
+};
+
+template class UidIndex<1>;
+template class UidIndex<2>;
+template class UidIndex<3>;
+template class UidIndex<4>;
+template class UidIndex<5>;
+
+#endif
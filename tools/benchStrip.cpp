@@ -0,0 +1,118 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Pixel strip benchmark
+
+    Measures frames per second for a strip of 1k and 10k pixels, first
+    encoding alone and then with range fades running across the whole
+    strip, into a MemorySink. Each encoded frame is decoded back and
+    compared against the framebuffer before timing starts. Build on a
+    host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/benchStrip.cpp -o benchStrip
+
+    Usage:
+
+        benchStrip [SECONDS]    Time per measurement (default 1)
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "PixelStrip.h"
+
+bool verify(const PixelStrip& strip, const MemorySink& sink) {
+    // Recovers each data bit from the middle line bit of its triplet
+    if (sink.data.size() != ((strip.frame.size() * 3) + WS2812_RESET_BYTES)) {
+        return false;
+    }
+    for (size_t i = 0; i < strip.frame.size(); ++i) {
+        uint32_t pattern = ((sink.data[i * 3] << 16) | (sink.data[(i * 3) + 1] << 8) | sink.data[(i * 3) + 2]);
+        uint8_t value = 0;
+        for (int bit = 7; bit >= 0; --bit) {
+            value = ((value << 1) | ((pattern >> ((bit * 3) + 1)) & 1));
+        }
+        if (value != strip.frame[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double measure(PixelStrip& strip, bool effects, double seconds) {
+    uint32_t frames = 0, time = 0;
+    auto started = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        if (effects && !strip.effectsQueued()) {
+            // Eight fades in parallel, each over its own slice
+            uint32_t slice = (strip.pixels / 8);
+            for (uint32_t i = 0; i < 8; ++i) {
+                std::array<uint8_t, 4> color = {
+                        static_cast<uint8_t>(frames * 7), static_cast<uint8_t>(i * 31), 200, 0
+                    };
+                strip.createEffect(color, (i * slice), slice, 0.5, 0, Easing::get(Easing::EASE_IN_OUT));
+            }
+        }
+        if (effects) {
+            strip.run(time);
+        } else {
+            strip.show();
+        }
+        time += 16667;
+        if (!(++frames % 16)) {
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        }
+    }
+    return (frames / elapsed);
+}
+
+int main(int argc, char** argv) {
+    double seconds = ((argc > 1) ? atof(argv[1]) : 1);
+    const uint32_t sizes[] = {1000, 10000};
+    for (uint32_t pixels: sizes) {
+        MemorySink sink;
+        PixelStrip strip(pixels, PixelStrip::GRB, &sink);
+        for (uint32_t i = 0; i < pixels; ++i) {
+            strip.set(i, {static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 3), static_cast<uint8_t>(~i), 0});
+        }
+        strip.show();
+        if (!verify(strip, sink)) {
+            fprintf(stderr, "Encoded frame does not match the framebuffer at %u pixels\n", pixels);
+            return 1;
+        }
+        double encodeRate = measure(strip, false, seconds);
+        double effectRate = measure(strip, true, seconds);
+        if (!verify(strip, sink)) {
+            fprintf(stderr, "Encoded frame does not match the framebuffer at %u pixels\n", pixels);
+            return 1;
+        }
+        printf(
+                "%6u pixels: %10.1f fps encode only, %10.1f fps with fades (%u bytes on the wire)\n",
+                pixels, encodeRate, effectRate, static_cast<uint32_t>(sink.data.size())
+            );
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Channel width benchmark
+
+    Compares the cost of one engine tick during an eased fade for the
+    fixed-width LedWriter<3> against DynamicWriter at 3, 8, 32 and 512
+    channels. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/benchWidth.cpp -o benchWidth
+
+    Usage:
+
+        benchWidth [TICKS]      Ticks per measurement (default 1000000)
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "LedWriter.h"
+#include "DynamicWriter.h"
+
+const Easing* curve = Easing::get(Easing::EASE_IN_OUT);
+
+double fixed(uint32_t ticks, uint16_t& checksum) {
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    auto started = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0, time = 0; tick < ticks; ++tick, time += 1000) {
+        if (writer.effectsQueued() < 2) {
+            uint16_t level = ((tick * 37) & 1023);
+            writer.createEffect({level, static_cast<uint16_t>(1023 - level), 512}, 0.25, false, 0, 0, 0, 0, false, 0, curve);
+        }
+        writer.run(time);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    checksum = writer.channels[0]->written;
+    return (elapsed * 1e9 / ticks);
+}
+
+double dynamic(uint32_t width, uint32_t ticks, uint16_t& checksum) {
+    DynamicWriter writer(width, 4);
+    std::vector<uint16_t> target(width);
+    auto started = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0, time = 0; tick < ticks; ++tick, time += 1000) {
+        if (writer.effectsQueued() < 2) {
+            for (uint32_t i = 0; i < width; ++i) {
+                target[i] = (((tick * 37) + (i * 101)) & 1023);
+            }
+            writer.createEffect(target.data(), 0.25, 0, 0, 0, curve);
+        }
+        writer.run(time);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    checksum = writer.values[0];
+    return (elapsed * 1e9 / ticks);
+}
+
+int main(int argc, char** argv) {
+    uint32_t ticks = ((argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000);
+    uint16_t checksum;
+    double cost = fixed(ticks, checksum);
+    printf("LedWriter<3>         %8.1f ns/tick %8.2f ns/channel (%u)\n", cost, (cost / 3), checksum);
+    const uint32_t widths[] = {3, 8, 32, 512};
+    for (uint32_t width: widths) {
+        // Fewer ticks at large widths keep each run about as long
+        uint32_t scaled = ((width > 32) ? (ticks / 16) : ticks);
+        cost = dynamic(width, scaled, checksum);
+        printf(
+                "DynamicWriter(%3u)   %8.1f ns/tick %8.2f ns/channel (%u)\n",
+                width, cost, (cost / width), checksum
+            );
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Clock synchronization demo
+
+    Forks a ClockSync master and several followers on localhost. Each
+    follower's local clock runs at a different rate and offset from the
+    shared monotonic clock, which stands in for true time. Followers
+    report their network time error once disciplined, then all schedule
+    one effect with createEffectAbsolute() at the same network time and
+    report how far from that instant it actually started. Exits
+    non-zero if any follower misses either by more than
+    DEMO_TOLERANCE. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/clockSync.cpp -o clockSync
+
+    Usage:
+
+        clockSync [FOLLOWERS] [SECONDS]     (default 3 10)
+*/
+
+#include <signal.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "ClockSync.h"
+#include "LedWriter.h"
+
+#define DEMO_PORT       16460
+#define DEMO_TOLERANCE  1000 // Microseconds of clock or start error a follower may show
+
+static uint64_t origin = 0;
+static double skew = 0; // Parts per million
+static int64_t offset = 0; // Microseconds
+
+uint64_t trueMicros() {
+    return ClockSync::localMicros();
+}
+
+uint64_t skewedMicros() {
+    // A crystal that is off by skew, started at an arbitrary time
+    uint64_t elapsed = (trueMicros() - origin);
+    return (origin + offset + static_cast<int64_t>(elapsed * (1 + (skew * 1e-6))));
+}
+
+void master(double duration) {
+    // The master's clock is true time, so followers can be checked against it
+    ClockSync sync(ClockSync::MASTER, trueMicros);
+    if (!sync.begin(DEMO_PORT)) {
+        fprintf(stderr, "Master unable to bind port %d\n", DEMO_PORT);
+        exit(1);
+    }
+    for (uint64_t stop = (trueMicros() + (duration * 1e6)); trueMicros() < stop;) {
+        sync.run();
+        usleep(100);
+    }
+    exit(0);
+}
+
+void follower(int index, double settle, uint64_t scheduled) {
+    ClockSync sync(ClockSync::FOLLOWER, skewedMicros);
+    if (!sync.begin(DEMO_PORT, "127.0.0.1")) {
+        fprintf(stderr, "Follower %d unable to open socket\n", index);
+        exit(1);
+    }
+    for (uint64_t stop = (origin + (settle * 1e6)); trueMicros() < stop;) {
+        sync.run();
+        usleep(200);
+    }
+
+    // Network time error over one second of continued polling
+    int64_t worst = 0;
+    for (uint64_t stop = (trueMicros() + 1000000); trueMicros() < stop;) {
+        sync.run();
+        int64_t error = (static_cast<int64_t>(sync.now()) - static_cast<int64_t>(trueMicros()));
+        worst = ((std::abs(error) > std::abs(worst)) ? error : worst);
+        usleep(1000);
+    }
+
+    // Every node starts the same effect at the same network time
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.scheduling = true;
+    writer.run(sync.now32());
+    writer.createEffectAbsolute({1023, 1023, 1023}, 0, false, static_cast<uint32_t>(scheduled));
+    uint64_t started = 0;
+    for (uint64_t stop = (scheduled + 2000000); !started && (trueMicros() < stop);) {
+        sync.run();
+        writer.run(sync.now32());
+        if (writer.channels[0]->value) {
+            started = trueMicros();
+        }
+        sched_yield();
+    }
+    int64_t late = (started ? (static_cast<int64_t>(started) - static_cast<int64_t>(scheduled)) : INT32_MAX);
+    bool passed = ((std::abs(worst) <= DEMO_TOLERANCE) && (std::abs(late) <= DEMO_TOLERANCE));
+    printf(
+            "Follower %d (%+6.0f ppm, %+8.3f s): %u exchanges, delay %3lld us, rate %.6f, "
+            "clock error %+5lld us, effect start error %+5lld us: %s\n",
+            index, skew, (offset * 1e-6), sync.exchanges, static_cast<long long>(sync.delay), sync.clock.rate,
+            static_cast<long long>(worst), static_cast<long long>(late), (passed ? "pass" : "FAIL")
+        );
+    exit(passed ? 0 : 1);
+}
+
+int main(int argc, char** argv) {
+    int followers = ((argc > 1) ? atoi(argv[1]) : 3);
+    double settle = ((argc > 2) ? atof(argv[2]) : 10);
+    origin = trueMicros();
+    uint64_t scheduled = (origin + ((settle + 2) * 1e6));
+
+    pid_t server = fork();
+    if (!server) {
+        master(settle + 4);
+    }
+    usleep(50000);
+    for (int i = 0; i < followers; ++i) {
+        if (!fork()) {
+            // Spread rates and offsets so no two followers agree
+            skew = (((i % 2) ? -1 : 1) * (100 + (i * 75)));
+            offset = ((i + 1) * 1234567) * ((i % 2) ? -1 : 1);
+            follower(i, settle, scheduled);
+        }
+    }
+    int status, failed = 0;
+    for (int i = 0; i < followers; ++i) {
+        wait(&status);
+        failed += (!WIFEXITED(status) || WEXITSTATUS(status));
+    }
+    kill(server, SIGTERM);
+    waitpid(server, &status, 0);
+    return (failed ? 1 : 0);
+}
@@ -0,0 +1,195 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/*
+    Bulk enqueue benchmark
+
+    Loads a 500-cue program through createEffects() and, for comparison,
+    one createEffect() call per cue, with and without UID lookup.
+    Checks that the bulk load queues every descriptor as described,
+    reserves the queue once, and that a bad descriptor anywhere in the
+    block rejects the whole block. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/createEffects.cpp -o createEffects
+
+    Usage:
+
+        createEffects [ROUNDS]      Loads timed per path (default 200)
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "LedWriter.h"
+
+#define CHECK_CUES      500
+
+static bool counting = false;
+static uint32_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations += counting;
+    void* allocated = malloc(size ? size : 1);
+    if (allocated == nullptr) {
+        throw std::bad_alloc();
+    }
+    return allocated;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+const Easing* curve = Easing::get(Easing::EASE_IN_OUT);
+
+std::vector<EffectDescriptor<3>> program() {
+    std::vector<EffectDescriptor<3>> cues(CHECK_CUES);
+    for (uint32_t i = 0; i < CHECK_CUES; ++i) {
+        uint16_t level = ((i * 97) & 1023);
+        cues[i].target = {level, static_cast<uint16_t>(1023 - level), 512};
+        cues[i].duration = (.05 + ((i % 7) * .01));
+        cues[i].start = (i * .1);
+        cues[i].hold = ((i % 5) ? 0 : .02);
+        cues[i].uid = (i + 1);
+        cues[i].loop = ((i % 11) ? 0 : 2);
+        cues[i].easing = ((i % 2) ? curve : nullptr);
+    }
+    return cues;
+}
+
+bool checkLoad() {
+    // Every cue lands as described, and the queue is reserved exactly once
+    std::vector<EffectDescriptor<3>> cues = program();
+    for (auto& cue: cues) {
+        // Holds allocate; leave them to the benchmark so the count is exact
+        cue.hold = 0;
+    }
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(1000);
+    uint32_t bits = writer.uidIndex->bits;
+    allocations = 0;
+    counting = true;
+    uint32_t created = writer.createEffects(cues.data(), CHECK_CUES);
+    counting = false;
+    uint32_t grows = (writer.uidIndex->bits - (bits ? bits : (UID_INDEX_MIN_BITS - 1)));
+    uint32_t reservations = (allocations - created - grows), wrong = 0;
+    for (uint32_t i = 0; i < created; ++i) {
+        Effect<3>* effect = writer.effects[i];
+        wrong += (
+                (effect->uid != cues[i].uid) || (effect->loop != cues[i].loop)
+                || (effect->easing != cues[i].easing) || (effect->target != cues[i].target)
+                || (effect->start != (1000 + static_cast<uint32_t>(cues[i].start * 1000000)))
+                || (writer.findEffect(cues[i].uid) != effect)
+            );
+    }
+    bool passed = ((created == CHECK_CUES) && (writer.effectsQueued() == CHECK_CUES) && !wrong && (reservations == 1));
+    printf(
+            "Load %s: %u of %u cues queued, %u differing from their descriptors, "
+            "%u queue reservations\n",
+            (passed ? "passed" : "FAILED"), created, CHECK_CUES, wrong, reservations
+        );
+    return passed;
+}
+
+bool checkValidation() {
+    // One bad descriptor, first, middle or last, rejects the whole block
+    const double bad[] = {NAN, INFINITY, -1};
+    uint32_t accepted = 0, queued = 0, trials = 0;
+    for (int field = 0; field < 3; ++field) {
+        for (double value: bad) {
+            for (uint32_t position: {0u, (CHECK_CUES / 2u), (CHECK_CUES - 1u)}) {
+                std::vector<EffectDescriptor<3>> cues = program();
+                double* fields[] = {&cues[position].duration, &cues[position].start, &cues[position].hold};
+                *fields[field] = value;
+                LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+                writer.run(0);
+                accepted += writer.createEffects(cues.data(), CHECK_CUES);
+                queued += (writer.effectsQueued() + writer.effectsScheduled());
+                trials++;
+            }
+        }
+    }
+    // Starts beyond the 32-bit clock's reach are rejected too
+    std::vector<EffectDescriptor<3>> cues = program();
+    cues.back().start = 4295;
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    accepted += writer.createEffects(cues.data(), CHECK_CUES);
+    queued += writer.effectsQueued();
+    trials++;
+    bool passed = (!accepted && !queued);
+    printf(
+            "Validation %s: %u blocks with one bad descriptor, %u effects accepted, %u queued\n",
+            (passed ? "passed" : "FAILED"), trials, accepted, queued
+        );
+    return passed;
+}
+
+double timed(uint8_t path, uint32_t rounds) {
+    // Mean microseconds per 500-cue load; clearing is not timed
+    std::vector<EffectDescriptor<3>> cues = program();
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    double total = 0;
+    for (uint32_t round = 0; round < rounds; ++round) {
+        auto started = std::chrono::steady_clock::now();
+        if (!path) {
+            writer.createEffects(cues.data(), CHECK_CUES);
+        } else {
+            for (auto& cue: cues) {
+                Effect<3>* effect = writer.createEffect(
+                        cue.target, cue.duration, false, cue.start, 0, 0,
+                        cue.uid, (path == 2), cue.loop, cue.easing
+                    );
+                if (cue.hold) {
+                    effect->hold(cue.hold, 1);
+                }
+            }
+        }
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        writer.clearEffects();
+    }
+    return (total * 1e6 / rounds);
+}
+
+int main(int argc, char** argv) {
+    uint32_t rounds = ((argc > 1) ? strtoul(argv[1], nullptr, 10) : 200);
+    bool passed = checkLoad();
+    passed &= checkValidation();
+    if (rounds) {
+        const char* paths[] = {"createEffects()", "createEffect() per cue", "createEffect() per cue, updateUID"};
+        for (uint8_t path = 0; path < 3; ++path) {
+            printf("%-34s %8.1f us per %u cues\n", paths[path], timed(path, rounds), CHECK_CUES);
+        }
+    }
+    return (passed ? 0 : 1);
+}
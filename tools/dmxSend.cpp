@@ -0,0 +1,119 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Network DMX sender benchmark
+
+    Drives many universes through DmxSender to a listener on localhost
+    on a virtual 44 Hz clock. Some universes change every frame and
+    the rest hold still. The tool checks that held universes are only
+    repeated as keep-alives and that every packet parses, then reports
+    the sender's cost per second of output. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/dmxSend.cpp -o dmxSend
+
+    Usage:
+
+        dmxSend [artnet|sacn] [UNIVERSES] [SECONDS]    (default sacn 256 10)
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "DmxSender.h"
+
+#define LISTENER_PORT   16455
+
+int main(int argc, char** argv) {
+    uint8_t protocol = (((argc > 1) && !strcmp(argv[1], "artnet")) ? DmxPacket::ARTNET : DmxPacket::E131);
+    uint32_t count = ((argc > 2) ? strtoul(argv[2], nullptr, 10) : 256);
+    double duration = ((argc > 3) ? atof(argv[3]) : 10);
+
+    int listener = socket(AF_INET, SOCK_DGRAM, 0);
+    int buffer = (8 << 20);
+    setsockopt(listener, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(LISTENER_PORT);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        fprintf(stderr, "Unable to bind port %d\n", LISTENER_PORT);
+        return 1;
+    }
+    fcntl(listener, F_SETFL, (fcntl(listener, F_GETFL) | O_NONBLOCK));
+
+    // One 512-channel source per universe; the first quarter animates
+    DmxSender sender(protocol);
+    std::vector<std::unique_ptr<DynamicWriter>> sources;
+    for (uint32_t i = 0; i < count; ++i) {
+        sources.emplace_back(new DynamicWriter(DMX_SLOTS, 1, 8));
+        sender.addUniverse((i + 1), "127.0.0.1", LISTENER_PORT)->patch(sources.back().get(), 1);
+    }
+    uint32_t animated = ((count + 3) / 4);
+    if (!sender.begin()) {
+        fprintf(stderr, "Unable to open sender\n");
+        return 1;
+    }
+
+    uint8_t packet[DMX_PACKET_MAX];
+    uint32_t received = 0, invalid = 0, frames = (duration * DMX_NETWORK_RATE);
+    std::vector<uint16_t> levels(DMX_SLOTS);
+    double busy = 0;
+    for (uint32_t frame = 0; frame <= frames; ++frame) {
+        uint32_t time = ((frame * 1000000ULL) / DMX_NETWORK_RATE);
+        for (uint32_t i = 0; i < animated; ++i) {
+            std::fill(levels.begin(), levels.end(), ((frame + i) & 0xFF));
+            sources[i]->set(levels.data());
+        }
+        auto started = std::chrono::steady_clock::now();
+        sender.run(time);
+        busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        for (ssize_t size; (size = recv(listener, packet, sizeof(packet), 0)) > 0;) {
+            DmxView view;
+            DmxPacket::parse(protocol, packet, size, view) ? received++ : invalid++;
+        }
+    }
+    close(listener);
+
+    // Animated universes every frame; held ones once plus keep-alives
+    uint32_t keepAlives = (duration / DMX_KEEPALIVE);
+    uint32_t expected = ((animated * (frames + 1)) + ((count - animated) * (1 + keepAlives)));
+    bool passed = (!invalid && (sender.packets == expected) && (received == sender.packets));
+    printf(
+            "%s: %u universes, %u packets sent (%u expected), %u received, %u skipped as unchanged\n",
+            (passed ? "Passed" : "FAILED"), count, sender.packets, expected, received, sender.skipped
+        );
+    printf(
+            "Sender time %.3f ms per second of output (%.2f us per frame, %.0f packets/s capacity)\n",
+            (busy * 1e3 / duration), (busy * 1e6 / (frames + 1)), (sender.packets / busy)
+        );
+    return (passed ? 0 : 1);
+}
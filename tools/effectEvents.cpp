@@ -0,0 +1,160 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Effect event check
+
+    Queues a fade, a held fade and two alternating looped fades,
+    records every event the writer emits while they play, and checks
+    the order and timing against the queue. Then runs the remote test sequence, whose global
+    save and recall now arrive through a listener, and counts heap
+    allocations made while events are delivered. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/effectEvents.cpp -o effectEvents
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "LedWriter.h"
+
+#define CHECK_TICK      100
+#define CHECK_SPAN      4000000
+#define CHECK_SLACK     1000 // Microseconds; about two fade steps
+
+static bool counting = false;
+static uint32_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations += counting;
+    void* allocated = malloc(size ? size : 1);
+    if (allocated == nullptr) {
+        throw std::bad_alloc();
+    }
+    return allocated;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+struct Record {
+    uint8_t type;
+    uint32_t uid, time;
+};
+
+const char* name(uint8_t type) {
+    switch (type) {
+        case EffectEvent<3>::ACTIVATED: return "activated";
+        case EffectEvent<3>::HOLD_STARTED: return "hold started";
+        case EffectEvent<3>::HOLD_ENDED: return "hold ended";
+        case EffectEvent<3>::LOOPED: return "looped";
+        case EffectEvent<3>::COMPLETED: return "completed";
+        case EffectEvent<3>::DRAINED: return "drained";
+    }
+    return "unknown";
+}
+
+void record(const EffectEvent<3>& event, void* context) {
+    Record entry = {event.type, event.uid, event.time};
+    static_cast<std::vector<Record>*>(context)->push_back(entry);
+}
+
+bool checkOrder() {
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    std::vector<Record> events;
+    events.reserve(64);
+    writer.listen(record, &events);
+    writer.run(0);
+    writer.createEffect({1023, 0, 0}, .5, false, 0, 0, 0, 10);
+    writer.createEffect({0, 1023, 0}, .4, false, 0, 0, 0, 20)->hold(.3, .5);
+    writer.createEffect({0, 0, 1023}, .2, false, 0, 0, 0, 30, false, 1);
+    writer.createEffect({0, 0, 200}, .2, false, 0, 0, 0, 40, false, 1);
+    counting = true;
+    for (uint32_t time = CHECK_TICK; time <= CHECK_SPAN; time += CHECK_TICK) {
+        writer.run(time);
+    }
+    counting = false;
+    writer.unlisten(record, &events);
+    for (auto& entry: events) {
+        printf("%8.4f s  UID %3u  %s\n", (entry.time * 1e-6), entry.uid, name(entry.type));
+    }
+    // Two passes of each looped fade; the second ones complete
+    const uint8_t expected[] = {
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::COMPLETED,
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::HOLD_STARTED,
+            EffectEvent<3>::HOLD_ENDED, EffectEvent<3>::COMPLETED,
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::LOOPED,
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::LOOPED,
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::COMPLETED,
+            EffectEvent<3>::ACTIVATED, EffectEvent<3>::COMPLETED,
+            EffectEvent<3>::DRAINED
+        };
+    bool ordered = (events.size() == (sizeof(expected) / sizeof(expected[0])));
+    for (size_t i = 0; ordered && (i < events.size()); ++i) {
+        ordered = (events[i].type == expected[i]);
+    }
+    // The hold lasts 0.3 s and begins halfway through its fade, give or take a step
+    uint32_t held = (events[4].time - events[3].time), into = (events[3].time - events[2].time);
+    bool timed = (
+            ordered && (std::abs(static_cast<int32_t>(held) - 300000) <= CHECK_SLACK)
+            && (std::abs(static_cast<int32_t>(into) - 200000) <= CHECK_SLACK)
+        );
+    printf(
+            "Order %s, hold timing %s (%u us into the fade, %u us held), "
+            "%u allocations while delivering\n",
+            (ordered ? "matched" : "DIFFERED"), (timed ? "matched" : "DIFFERED"),
+            into, held, allocations
+        );
+    return (ordered && timed && !allocations);
+}
+
+bool checkGlobalSave() {
+    // test() saves the current color globally and recalls it at the end
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    writer.set({100, 200, 300}, true);
+    writer.test(.7);
+    for (uint32_t time = CHECK_TICK; time <= CHECK_SPAN; time += CHECK_TICK) {
+        writer.run(time);
+    }
+    std::array<uint16_t, 3> current = writer.getCurrent();
+    bool restored = ((current[0] == 100) && (current[1] == 200) && (current[2] == 300) && !writer.effectsQueued());
+    printf(
+            "Global recall %s: %u, %u, %u after the test sequence\n",
+            (restored ? "restored" : "FAILED"), current[0], current[1], current[2]
+        );
+    return restored;
+}
+
+int main() {
+    bool passed = checkOrder();
+    passed = (checkGlobalSave() && passed);
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,164 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Queue prediction check
+
+    Queues stepped and eased fades, holds, a timeline and finite and
+    endless loops, predicts the output over the next twelve seconds with
+    evaluateAt(), then plays the queue and compares. A second writer
+    plays the same queue without being queried, to show prediction
+    leaves live state alone, and checks that times outside the
+    prediction window are reported unknown. Finally reports index build and lookup
+    cost against queue length. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/evaluateAt.cpp -o evaluateAt
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "LedWriter.h"
+
+#define CHECK_TICK      20 // Microseconds per engine tick
+#define CHECK_SPAN      12000000
+#define CHECK_SAMPLE    1000
+#define CHECK_SLACK     3 // Samples the engine may trail by; it takes a few ticks per hand-off
+
+const Easing* curve = Easing::get(Easing::EASE_IN_OUT);
+
+double seconds(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+void show(LedWriter<3>& writer) {
+    writer.run(0);
+    writer.createEffect({1023, 0, 0}, .5);
+    Effect<3>* held = writer.createEffect({0, 1023, 0}, .4, false, 0, 0, 0, 0, false, 0, curve);
+    held->hold(.1, .5);
+    held->hold(.2, 1);
+    writer.createTimeline({
+            {100000, {200, 200, 200}, nullptr},
+            {300000, {0, 600, 900}, curve}
+        }, 0, 0, 2);
+    writer.createEffect({0, 0, 512}, .3, false, 0, 0, 0, 0, false, 3);
+    writer.createEffect({800, 100, 0}, .25, false, 0, 0, 0, 0, false, -1, curve);
+    writer.createEffect({100, 800, 300}, .35, false, 0, 0, 0, 0, false, -1);
+}
+
+bool checkPrediction() {
+    LedWriter<3> queried(std::array<uint8_t, 3>{}, 10, false), untouched(std::array<uint8_t, 3>{}, 10, false);
+    show(queried);
+    show(untouched);
+    std::vector<std::array<uint16_t, 3>> predicted;
+    uint32_t unknown = 0;
+    for (uint32_t time = 0; time <= CHECK_SPAN; time += CHECK_SAMPLE) {
+        bool known;
+        predicted.push_back(queried.evaluateAt(time, &known));
+        unknown += !known;
+    }
+    // Before the anchor, and beyond the 32-bit clock's reach ahead of it
+    LedWriter<3> windowed(std::array<uint8_t, 3>{}, 10, false);
+    bool early = true, distant = true;
+    show(windowed);
+    windowed.run(1000);
+    windowed.evaluateAt(0, &early);
+    windowed.evaluateAt(2400000000u, &distant);
+    uint32_t worst = 0, exact = 0, close = 0, samples = 0, diverged = 0;
+    for (uint32_t time = CHECK_TICK; time <= CHECK_SPAN; time += CHECK_TICK) {
+        queried.run(time);
+        untouched.run(time);
+        if (!(time % 997)) {
+            queried.evaluateAt(time + 5000);
+        }
+        for (int i = 0; i < 3; ++i) {
+            diverged += (queried.channels[i]->value != untouched.channels[i]->value);
+        }
+        if (!(time % CHECK_SAMPLE)) {
+            uint32_t sample = (time / CHECK_SAMPLE), nearest = UINT32_MAX;
+            for (uint32_t lag = 0; (lag <= CHECK_SLACK) && (lag <= sample); ++lag) {
+                uint32_t error = 0;
+                for (int i = 0; i < 3; ++i) {
+                    error = std::max<uint32_t>(error, std::abs(queried.channels[i]->value - predicted[sample - lag][i]));
+                }
+                nearest = std::min(nearest, error);
+                if (!lag) {
+                    worst = std::max(worst, error);
+                    exact += (error <= 10);
+                }
+            }
+            close += (nearest <= 10);
+            samples++;
+        }
+    }
+    bool passed = (!diverged && !unknown && !early && !distant && (close >= (samples * .99)));
+    printf(
+            "Prediction %s: of %u samples, %.2f%% within 1%% of full scale (worst %u), "
+            "%.2f%% allowing %u ms of engine lag; %u ticks where querying changed output; "
+            "%u samples unknown, out-of-window times %s\n",
+            (passed ? "passed" : "FAILED"), samples, (exact * 100.0 / samples), worst,
+            (close * 100.0 / samples), CHECK_SLACK, diverged, unknown,
+            ((early || distant) ? "predicted" : "unknown")
+        );
+    return passed;
+}
+
+void benchmark(uint32_t count) {
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t level = ((i * 97) & 1023);
+        Effect<3>* effect = writer.createEffect(
+                {level, static_cast<uint16_t>(1023 - level), 512}, .05, false, 0, 0, 0, 0, false,
+                ((i % 7) ? 0 : 3), ((i % 2) ? curve : nullptr)
+            );
+        if (!(i % 5)) {
+            effect->hold(.01, .5);
+        }
+    }
+    auto started = std::chrono::steady_clock::now();
+    writer.evaluateAt(0);
+    double built = seconds(started);
+    uint64_t length = writer.queueIndex->length(), checksum = 0;
+    uint32_t lookups = 1000000;
+    started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        checksum += writer.evaluateAt((i * 2654435761ULL) % length)[0];
+    }
+    double looked = seconds(started);
+    printf(
+            "%5u effects: %5zu groups, build %8.1f us, lookup %5.0f ns (checksum %llu)\n",
+            count, writer.queueIndex->groups.size(), (built * 1e6), (looked * 1e9 / lookups),
+            static_cast<unsigned long long>(checksum)
+        );
+}
+
+int main() {
+    bool passed = checkPrediction();
+    for (uint32_t count: {10, 100, 1000}) {
+        benchmark(count);
+    }
+    return (passed ? 0 : 1);
+}
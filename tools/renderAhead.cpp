@@ -0,0 +1,200 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Look-ahead output check
+
+    Plays the same fades three ways against a main loop that stalls now
+    and then: directly from loop(), through a RenderBuffer whose output
+    stage runs every millisecond, and through one whose stalls outlast
+    the look-ahead. Each output is compared with an ideal engine run
+    once per millisecond on a virtual clock. Then runs the buffer on the
+    real clock, sent by an output thread and by a periodic timer, and
+    reports the cost of tick(). Build on a host with:
+
+        g++ -std=c++17 -O2 -pthread -Isrc src/[A-Z]*.cpp tools/renderAhead.cpp -o renderAhead
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "RenderBuffer.h"
+
+#define CHECK_SPAN      10000000
+#define CHECK_FRAME     1000
+#define CHECK_LOOP      1000 // Microseconds between main loop passes when not stalled
+
+struct Result {
+    uint32_t worst = 0, off = 0, ticks = 0;
+};
+
+void show(LedWriter<3>& writer) {
+    writer.run(0);
+    writer.createEffect({1023, 0, 0}, .4, false, 0, 0, 0, 0, false, -1);
+    writer.createEffect({0, 1023, 300}, .7, false, 0, 0, 0, 0, false, -1, Easing::get(Easing::EASE_IN_OUT));
+    writer.createEffect({0, 0, 1023}, .3, false, 0, 0, 0, 0, false, -1);
+}
+
+uint32_t stall(uint32_t pass, uint32_t longest) {
+    // Deterministic, roughly one stall of up to longest per 150 passes
+    uint32_t hash = (pass * 2654435761u);
+    return ((hash % 150) ? 0 : ((hash >> 8) % longest));
+}
+
+std::vector<std::array<uint16_t, 3>> reference() {
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    show(writer);
+    std::vector<std::array<uint16_t, 3>> frames;
+    for (uint32_t time = 0; time <= CHECK_SPAN; time += CHECK_FRAME) {
+        writer.run(time);
+        frames.push_back({writer.channels[0]->written, writer.channels[1]->written, writer.channels[2]->written});
+    }
+    return frames;
+}
+
+void score(Result& result, const std::array<uint16_t, 3>& out, const std::array<uint16_t, 3>& ideal) {
+    uint32_t error = 0;
+    for (int i = 0; i < 3; ++i) {
+        error = std::max<uint32_t>(error, std::abs(out[i] - ideal[i]));
+    }
+    result.worst = std::max(result.worst, error);
+    result.off += (error > 10);
+    result.ticks++;
+}
+
+Result direct(const std::vector<std::array<uint16_t, 3>>& ideal, uint32_t longest) {
+    // Outputs hold whatever loop() last wrote when each millisecond falls
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    show(writer);
+    Result result;
+    uint32_t wake = 0, pass = 0;
+    for (uint32_t time = 0; time <= CHECK_SPAN; time += CHECK_FRAME) {
+        while (wake <= time) {
+            writer.run(wake);
+            wake += (CHECK_LOOP + stall(pass++, longest));
+        }
+        score(result, {writer.channels[0]->written, writer.channels[1]->written, writer.channels[2]->written}, ideal[time / CHECK_FRAME]);
+    }
+    return result;
+}
+
+Result buffered(const std::vector<std::array<uint16_t, 3>>& ideal, uint32_t longest, RenderBuffer<3>*& kept) {
+    LedWriter<3>* writer = new LedWriter<3>(std::array<uint8_t, 3>{}, 10, false);
+    show(*writer);
+    RenderBuffer<3>* buffer = new RenderBuffer<3>(writer, .05, 1e6 / CHECK_FRAME);
+    buffer->start(0);
+    Result result;
+    uint32_t wake = 0, pass = 0;
+    for (uint32_t time = 0; time <= CHECK_SPAN; time += CHECK_FRAME) {
+        while (wake <= time) {
+            buffer->render(wake);
+            wake += (CHECK_LOOP + stall(pass++, longest));
+        }
+        buffer->output(time);
+        score(result, buffer->sent, ideal[time / CHECK_FRAME]);
+    }
+    kept = buffer;
+    return result;
+}
+
+void report(const char* name, const Result& result) {
+    printf(
+            "%-26s worst error %4u, %5.2f%% of %u ms off by more than 1%% of full scale\n",
+            name, result.worst, (result.off * 100.0 / result.ticks), result.ticks
+        );
+}
+
+bool realtime(bool timer) {
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(RenderBuffer<3>::sampleClock());
+    writer.createEffect({1023, 0, 0}, .4, false, 0, 0, 0, 0, false, -1);
+    RenderBuffer<3> buffer(&writer);
+    buffer.start();
+    buffer.render();
+    if (timer) {
+        if (!buffer.startTimer()) {
+            return false;
+        }
+    } else {
+        buffer.startOutput();
+    }
+    auto started = std::chrono::steady_clock::now();
+    uint32_t pass = 0;
+    while ((std::chrono::steady_clock::now() - started) < std::chrono::seconds(3)) {
+        buffer.render();
+        std::this_thread::sleep_for(std::chrono::microseconds(CHECK_LOOP + stall(pass++, 30000)));
+    }
+    buffer.stop();
+    printf(
+            "%-26s %u underruns, %u frames skipped, %u timer periods missed, %u render restarts\n",
+            (timer ? "Real clock, timer, 3 s:" : "Real clock, thread, 3 s:"),
+            buffer.underruns, buffer.skipped, buffer.overruns, buffer.resumed
+        );
+    return !buffer.underruns;
+}
+
+void tickCost() {
+    // Worst case per call: every channel changes on every frame
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    writer.run(0);
+    writer.createEffect({1023, 1023, 1023}, .001, false, 0, 0, 0, 0, false, -1);
+    RenderBuffer<3> buffer(&writer, .05, 1e6);
+    uint32_t calls = 1000000, sent = 0;
+    buffer.start(0);
+    std::chrono::steady_clock::duration spent{};
+    for (uint32_t time = 0; time < calls; time += 32) {
+        buffer.render(time);
+        auto before = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 32; ++i) {
+            sent += buffer.output(time + i);
+        }
+        spent += (std::chrono::steady_clock::now() - before);
+    }
+    printf(
+            "Output stage: %.1f ns per call over %u calls, %u frames sent\n",
+            (std::chrono::duration<double>(spent).count() * 1e9 / calls), calls, sent
+        );
+}
+
+int main() {
+    std::vector<std::array<uint16_t, 3>> ideal = reference();
+    RenderBuffer<3>* covered = nullptr;
+    RenderBuffer<3>* exceeded = nullptr;
+    Result loop = direct(ideal, 40000);
+    Result ahead = buffered(ideal, 40000, covered);
+    Result overrun = buffered(ideal, 120000, exceeded);
+    report("Direct, stalls <= 40 ms:", loop);
+    report("50 ms ahead, <= 40 ms:", ahead);
+    printf("%26s %u underruns, %u render restarts\n", "", covered->underruns, covered->resumed);
+    report("50 ms ahead, <= 120 ms:", overrun);
+    printf("%26s %u underruns, %u render restarts\n", "", exceeded->underruns, exceeded->resumed);
+    bool passed = (!ahead.off && !covered->underruns && exceeded->underruns);
+    passed = (realtime(false) && passed);
+    passed = (realtime(true) && passed);
+    tickCost();
+    printf("Look-ahead check %s\n", (passed ? "passed" : "FAILED"));
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,154 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Batch show renderer
+
+    Renders one show on many fixtures at once through OfflineRenderer,
+    for previsualization and to measure how throughput scales with
+    threads. Build on a host with:
+
+        g++ -std=c++17 -O2 -pthread -Isrc src/[A-Z]*.cpp tools/renderBatch.cpp -o renderBatch
+
+    Usage:
+
+        renderBatch SHOW [options]
+            -n COUNT    Fixtures to render (default 256)
+            -j THREADS  Worker threads; all cores if omitted
+            -d SECONDS  Length to render (default 60)
+            -r HZ       Frame rate (default 100)
+            -t US       Engine tick in microseconds (default 1000)
+            -o PATH     Frame output; uint16_t per channel, little-endian,
+                        all frames of fixture 0 followed by fixture 1, ...
+
+    Fixture seconds rendered per wall second are reported on stderr.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "OfflineRenderer.h"
+
+struct BatchOptions {
+    const char* show = nullptr;
+    const char* output = nullptr;
+    uint32_t count = 256, tick = 1000;
+    unsigned int threads = 0;
+    double rate = 100, duration = 60;
+};
+
+template <unsigned int N>
+int render(const BatchOptions& options, MappedShow& show) {
+    uint32_t frameCount = (options.duration * options.rate);
+    OfflineRenderer<N> renderer(frameCount, options.rate, options.tick, options.threads);
+    std::vector<std::unique_ptr<LedWriter<N>>> writers;
+    std::vector<std::unique_ptr<MemoryShow>> sources;
+    std::vector<std::unique_ptr<ShowPlayer<N>>> players;
+    for (uint32_t i = 0; i < options.count; ++i) {
+        // Every fixture reads the same mapping through its own cursor
+        writers.emplace_back(new LedWriter<N>(std::array<uint8_t, N>{}, 10, false));
+        writers.back()->scheduling = true;
+        writers.back()->seed(i);
+        sources.emplace_back(new MemoryShow(show.data, show.size));
+        players.emplace_back(new ShowPlayer<N>(writers.back().get(), sources.back().get()));
+        if (!players.back()->open()) {
+            fprintf(stderr, "Unable to read show %s\n", options.show);
+            return 1;
+        }
+        renderer.add(writers.back().get(), players.back().get());
+    }
+    auto started = std::chrono::steady_clock::now();
+    renderer.render();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (options.output != nullptr) {
+        FILE* output = fopen(options.output, "wb");
+        if (output == nullptr) {
+            fprintf(stderr, "Unable to open %s\n", options.output);
+            return 1;
+        }
+        for (auto& fixture: renderer.fixtures) {
+            for (uint16_t value: fixture.frames) {
+                uint8_t bytes[2] = {static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>(value >> 8)};
+                fwrite(bytes, 1, 2, output);
+            }
+        }
+        fclose(output);
+    }
+    double simulated = (options.count * options.duration);
+    fprintf(
+            stderr, "Rendered %u fixtures x %.1f s on %u threads in %.3f s (%.1f fixture s per wall s)\n",
+            options.count, options.duration, renderer.workers, wall,
+            (simulated / (wall > 0 ? wall : 1e-9))
+        );
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = ((i + 1) < argc);
+        if (!strcmp(argv[i], "-n") && hasValue) {
+            options.count = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "-j") && hasValue) {
+            options.threads = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "-d") && hasValue) {
+            options.duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && hasValue) {
+            options.rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && hasValue) {
+            options.tick = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "-o") && hasValue) {
+            options.output = argv[++i];
+        } else if (argv[i][0] != '-') {
+            options.show = argv[i];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (
+            (options.show == nullptr) || !options.count
+            || (options.rate <= 0) || (options.rate > 1e6) || (options.duration <= 0) || !options.tick
+        ) {
+        fprintf(stderr, "Usage: renderBatch SHOW [-n COUNT] [-j THREADS] [-d SECONDS] [-r HZ] [-t US] [-o PATH]\n");
+        return 2;
+    }
+    MappedShow show;
+    if (!show.open(options.show) || (show.size < SHOW_HEADER_SIZE)) {
+        fprintf(stderr, "Unable to map %s\n", options.show);
+        return 1;
+    }
+    switch (ShowSource::decode16(show.data + 6)) {
+        case 1: return render<1>(options, show);
+        case 2: return render<2>(options, show);
+        case 3: return render<3>(options, show);
+        case 4: return render<4>(options, show);
+        case 5: return render<5>(options, show);
+        default:
+            fprintf(stderr, "Unsupported channel count\n");
+            return 1;
+    }
+}
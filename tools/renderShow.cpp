@@ -0,0 +1,179 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Headless show renderer
+
+    Plays a binary show through the real LedWriter engine on a virtual
+    clock, as fast as the host allows, and writes per-channel output
+    traces. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/renderShow.cpp -o renderShow
+
+    Usage:
+
+        renderShow SHOW [options]
+            -o PATH     Trace output; stdout if omitted
+            -f FORMAT   csv (default) or bin; bin records are a uint32_t
+                        time in microseconds followed by one uint16_t per
+                        channel, little-endian
+            -r HZ       Trace sample rate, up to 1000000 (default 100)
+            -t US       Engine tick in microseconds (default 1000)
+            -d SECONDS  Length to render; until the show ends if omitted
+            -b BITS     Output resolution (default 10)
+
+    Throughput in simulated seconds per wall second is reported on stderr.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ShowFile.h"
+
+struct RenderOptions {
+    const char* show = nullptr;
+    const char* output = nullptr;
+    bool binary = false;
+    double rate = 100, duration = 0;
+    uint32_t tick = 1000;
+    uint8_t resolution = 10;
+};
+
+template <unsigned int N>
+int render(const RenderOptions& options, MappedShow& show) {
+    // Pins are irrelevant without hardware
+    LedWriter<N> writer(std::array<uint8_t, N>{}, options.resolution, false);
+    writer.scheduling = true;
+    writer.run(0);
+    ShowPlayer<N> player(&writer, &show);
+    if (!player.open()) {
+        fprintf(stderr, "Unable to read show %s\n", options.show);
+        return 1;
+    }
+    FILE* trace = (options.output != nullptr ? fopen(options.output, (options.binary ? "wb" : "w")) : stdout);
+    if (trace == nullptr) {
+        fprintf(stderr, "Unable to open %s\n", options.output);
+        return 1;
+    }
+    if (!options.binary) {
+        fprintf(trace, "time_us");
+        for (unsigned int i = 0; i < N; ++i) {
+            fprintf(trace, ",channel%u", i);
+        }
+        fprintf(trace, "\n");
+    }
+    uint64_t interval = (1e6 / options.rate), limit = (options.duration * 1e6);
+    uint64_t time = 0, nextSample = 0;
+    auto started = std::chrono::steady_clock::now();
+    player.play();
+    while (true) {
+        bool cuesLeft = player.run();
+        writer.run(static_cast<uint32_t>(time));
+        while (nextSample <= time) {
+            if (options.binary) {
+                uint8_t record[4 + (N * 2)];
+                for (int i = 0; i < 4; ++i) {
+                    record[i] = ((nextSample >> (i * 8)) & 0xFF);
+                }
+                for (unsigned int i = 0; i < N; ++i) {
+                    record[4 + (i * 2)] = (writer.channels[i]->written & 0xFF);
+                    record[5 + (i * 2)] = (writer.channels[i]->written >> 8);
+                }
+                fwrite(record, 1, sizeof(record), trace);
+            } else {
+                fprintf(trace, "%llu", static_cast<unsigned long long>(nextSample));
+                for (unsigned int i = 0; i < N; ++i) {
+                    fprintf(trace, ",%u", writer.channels[i]->written);
+                }
+                fprintf(trace, "\n");
+            }
+            nextSample += interval;
+        }
+        bool finished = (
+                limit
+                ? (time >= limit)
+                : (!cuesLeft && !writer.effectsQueued() && !writer.effectsScheduled())
+            );
+        if (finished) {
+            break;
+        }
+        time += options.tick;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (trace != stdout) {
+        fclose(trace);
+    }
+    fprintf(
+            stderr, "Rendered %.3f s of %u cues in %.3f s (%.1f simulated s per wall s)\n",
+            (time * 1e-6), player.cues, wall, ((time * 1e-6) / (wall > 0 ? wall : 1e-9))
+        );
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    RenderOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = ((i + 1) < argc);
+        if (!strcmp(argv[i], "-o") && hasValue) {
+            options.output = argv[++i];
+        } else if (!strcmp(argv[i], "-f") && hasValue) {
+            options.binary = !strcmp(argv[++i], "bin");
+        } else if (!strcmp(argv[i], "-r") && hasValue) {
+            options.rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && hasValue) {
+            options.tick = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "-d") && hasValue) {
+            options.duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-b") && hasValue) {
+            options.resolution = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            options.show = argv[i];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    // Above 1 MHz the sample interval would truncate to zero microseconds
+    if ((options.show == nullptr) || (options.rate <= 0) || (options.rate > 1e6) || !options.tick) {
+        fprintf(stderr, "Usage: renderShow SHOW [-o PATH] [-f csv|bin] [-r HZ] [-t US] [-d SECONDS] [-b BITS]\n");
+        return 2;
+    }
+    MappedShow show;
+    if (!show.open(options.show) || (show.size < SHOW_HEADER_SIZE)) {
+        fprintf(stderr, "Unable to map %s\n", options.show);
+        return 1;
+    }
+    // Channel count from the header selects the engine width
+    switch (ShowSource::decode16(show.data + 6)) {
+        case 1: return render<1>(options, show);
+        case 2: return render<2>(options, show);
+        case 3: return render<3>(options, show);
+        case 4: return render<4>(options, show);
+        case 5: return render<5>(options, show);
+        default:
+            fprintf(stderr, "Unsupported channel count\n");
+            return 1;
+    }
+}
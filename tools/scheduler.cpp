@@ -0,0 +1,191 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/*
+    Scheduler check
+
+    Inserts, reschedules and cancels future-dated effects at random
+    while the clock runs across its 32-bit rollover, and checks after
+    every tick that the heap is well formed and releases exactly what a
+    sorted reference list says is due, in start order. Then checks that
+    a writer retiming an effect by UID, through retimeEffects() or
+    createEffectAbsolute() with updateUID, moves it in the heap. Build
+    on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/scheduler.cpp -o scheduler
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "LedWriter.h"
+
+#define CHECK_START     (UINT32_MAX - 3000000) // Three seconds before the clock wraps
+#define CHECK_STEPS     20000
+#define CHECK_AHEAD     2000000 // Furthest start, in microseconds
+
+Random rng(1980);
+
+struct Pending {
+    uint64_t due;
+    Effect<1>* effect;
+};
+
+bool wellFormed(Scheduler<1>& scheduler) {
+    // Every entry knows its position and no child is due before its parent
+    for (uint32_t i = 0; i < scheduler.heap.size(); ++i) {
+        if (scheduler.heap[i].effect->scheduled != static_cast<int32_t>(i)) {
+            return false;
+        }
+        if (i && (scheduler.heap[(i - 1) / 2].due > scheduler.heap[i].due)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkHeap() {
+    LedWriter<1> writer(std::array<uint8_t, 1>{}, 10, false);
+    Scheduler<1> scheduler(64);
+    std::vector<Pending> reference;
+    uint32_t now = CHECK_START, malformed = 0, mismatched = 0, unordered = 0;
+    uint32_t released = 0, rescheduled = 0, cancelled = 0;
+    uint64_t clock = now;
+    scheduler.advance(now);
+    for (uint32_t step = 0; step < CHECK_STEPS; ++step) {
+        uint32_t roll = rng.below(100);
+        if ((roll < 40) || reference.empty()) {
+            uint32_t ahead = rng.below(CHECK_AHEAD);
+            Effect<1>* effect = new Effect<1>({0}, &writer.channels, &writer.now);
+            effect->start = (now + ahead);
+            scheduler.insert(effect, now);
+            reference.push_back({clock + ahead, effect});
+        } else if (roll < 55) {
+            Pending& moved = reference[rng.below(reference.size())];
+            uint32_t ahead = rng.below(CHECK_AHEAD);
+            moved.effect->start = (now + ahead);
+            moved.due = (clock + ahead);
+            scheduler.reschedule(moved.effect, now);
+            rescheduled++;
+        } else if (roll < 65) {
+            uint32_t chosen = rng.below(reference.size());
+            scheduler.remove(reference[chosen].effect);
+            mismatched += (reference[chosen].effect->scheduled != -1);
+            delete reference[chosen].effect;
+            reference.erase(reference.begin() + chosen);
+            cancelled++;
+        } else {
+            uint32_t elapsed = (rng.below(2000) + 1);
+            now += elapsed;
+            clock += elapsed;
+            std::vector<Effect<1>*> expected, expired;
+            for (auto& pending: reference) {
+                if (pending.due <= clock) {
+                    expected.push_back(pending.effect);
+                }
+            }
+            reference.erase(
+                    std::remove_if(reference.begin(), reference.end(), [&](const Pending& pending) {
+                        return (pending.due <= clock);
+                    }),
+                    reference.end()
+                );
+            uint64_t previous = 0;
+            for (Effect<1>* due; (due = scheduler.expire(now)) != nullptr;) {
+                uint64_t start = (clock + static_cast<int32_t>(due->start - now));
+                unordered += (start < previous);
+                previous = start;
+                expired.push_back(due);
+            }
+            std::sort(expected.begin(), expected.end());
+            std::sort(expired.begin(), expired.end());
+            mismatched += (expected != expired);
+            released += expired.size();
+            for (auto effect: expired) {
+                delete effect;
+            }
+        }
+        malformed += !wellFormed(scheduler);
+        mismatched += (scheduler.pending() != reference.size());
+    }
+    for (auto& pending: reference) {
+        scheduler.remove(pending.effect);
+        delete pending.effect;
+    }
+    bool wrapped = (clock > UINT32_MAX);
+    bool passed = (!malformed && !mismatched && !unordered && wrapped && released && !scheduler.pending());
+    printf(
+            "Heap %s: clock %s 32 bits; %u released, %u rescheduled, %u cancelled; "
+            "%u malformed, %u mismatched, %u out of order\n",
+            (passed ? "passed" : "FAILED"), (wrapped ? "ran past" : "stayed within"),
+            released, rescheduled, cancelled, malformed, mismatched, unordered
+        );
+    return passed;
+}
+
+bool checkWriter() {
+    // Retiming by UID must re-key the heap, or the effect starts at its old time
+    LedWriter<1> idle(std::array<uint8_t, 1>{}, 10, false), writer(std::array<uint8_t, 1>{}, 10, false);
+    idle.scheduling = true;
+    idle.run(0);
+    idle.createEffect({1023});
+    bool lazy = (idle.scheduler->heap.capacity() == 0);
+    writer.scheduling = true;
+    uint32_t now = (UINT32_MAX - 50000); // Both retimed starts fall after the wrap
+    writer.run(now);
+    Effect<1>* moved = writer.createEffectAbsolute({1023}, 1e-3, false, (now + 500000), 0, 0, 3);
+    Effect<1>* retimed = writer.createEffectAbsolute({1023}, 1e-3, false, (now + 400000), 0, 0, 4);
+    writer.createEffectAbsolute({512}, 1e-3, false, (now + 300000), 0, 0, 5);
+    Effect<1>* updated = writer.createEffectAbsolute({0}, 1e-3, false, (now + 100000), 0, 0, 3, true);
+    writer.retimeEffects(4, 1e-3, (now + 150000));
+    bool cancelled = ((writer.cancelEffects(5) == 1) && (writer.effectsScheduled() == 2));
+    bool reused = ((updated == moved) && (writer.effectsScheduled() == 2));
+    uint32_t firstStart = 0, secondStart = 0;
+    for (uint32_t time = now; (time - now) < 600000; time += 1000) {
+        writer.run(time);
+        if (!firstStart && (moved->scheduled < 0)) {
+            firstStart = (time - now);
+        }
+        if (!secondStart && (retimed->scheduled < 0)) {
+            secondStart = (time - now);
+        }
+    }
+    bool prompt = ((firstStart == 100000) && (secondStart == 150000));
+    bool passed = (lazy && cancelled && reused && prompt);
+    printf(
+            "Writer %s: heap %s until needed; updateUID %s; retimed effects released at "
+            "%u us and %u us (want 100000 and 150000) across rollover; cancel %s\n",
+            (passed ? "passed" : "FAILED"), (lazy ? "unreserved" : "reserved"),
+            (reused ? "reused the effect" : "created another"), firstStart, secondStart,
+            (cancelled ? "removed the scheduled effect" : "left it scheduled")
+        );
+    return passed;
+}
+
+int main() {
+    bool passed = checkHeap();
+    passed &= checkWriter();
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,163 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Show file round trip check
+
+    Records a show with ShowRecorder: eased and held fades, loops, a
+    timeline, a cue of a type this reader does not know, and a final
+    cue past the 32-bit microsecond range. Plays it from memory, from a
+    mapped file and through a stream, and compares every tick against
+    a writer given the same cues directly. Build on a host with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/showRoundTrip.cpp -o showRoundTrip
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include "ShowFile.h"
+
+#define CHECK_TICK      1000
+#define CHECK_LATE      4500000000ULL // Microseconds; 75 minutes
+#define CHECK_PATH      "showRoundTrip.show"
+
+const Easing* curve = Easing::get(Easing::EASE_IN_OUT);
+
+const std::vector<Keyframe<3>> keyframes = {
+        {200000, {200, 200, 200}, nullptr},
+        {500000, {0, 600, 900}, curve}
+    };
+
+void record(ShowRecorder<3>& recorder) {
+    recorder.addEffect({1023, 0, 0}, 0, 500000, 0, 1, 0, curve);
+    recorder.addEffect({0, 1023, 0}, 600000, 400000, 300000, 2);
+    recorder.addTimeline(keyframes, 1500000, 3, 1);
+    recorder.addEffect({0, 0, 512}, 3000000, 300000, 0, 4, 2);
+    // A cue type from a later writer, carrying one record of its own
+    recorder.data.push_back(0x7F);
+    recorder.data.push_back(SHOW_CURVE_NONE);
+    ShowSource::encode16(recorder.data, 1);
+    ShowSource::encode64(recorder.data, 4000000);
+    recorder.data.resize(recorder.data.size() + (SHOW_CUE_SIZE - 12) + 6 + SHOW_KEYFRAME_SIZE + 6, 0xEE);
+    recorder.cues++;
+    for (int i = 0; i < 4; ++i) {
+        recorder.data[8 + i] = ((recorder.cues >> (i * 8)) & 0xFF);
+    }
+    recorder.addEffect({300, 300, 300}, 5000000, 200000, 0, 5);
+    recorder.addEffect({800, 100, 0}, CHECK_LATE, 250000, 0, 6, 0, curve);
+}
+
+void queue(LedWriter<3>& writer) {
+    // The same cues bar the late one, as a sketch would queue them
+    writer.createEffectAbsolute({1023, 0, 0}, .5, false, 0, 0, 0, 1, false, 0, curve);
+    writer.createEffectAbsolute({0, 1023, 0}, .4, false, 600000, 0, 0, 2)->hold(.3, 1);
+    writer.createTimelineAbsolute(keyframes, 1500000, 3, 1);
+    writer.createEffectAbsolute({0, 0, 512}, .3, false, 3000000, 0, 0, 4, false, 2);
+    writer.createEffectAbsolute({300, 300, 300}, .2, false, 5000000, 0, 0, 5);
+}
+
+size_t readFile(void* context, uint8_t* buffer, size_t length) {
+    return fread(buffer, 1, length, static_cast<FILE*>(context));
+}
+
+bool rewindFile(void* context) {
+    return !fseek(static_cast<FILE*>(context), 0, SEEK_SET);
+}
+
+int main() {
+    ShowRecorder<3> recorder;
+    record(recorder);
+    if (!recorder.save(CHECK_PATH)) {
+        fprintf(stderr, "Unable to write %s\n", CHECK_PATH);
+        return 1;
+    }
+    MemoryShow memory(recorder.data.data(), recorder.data.size());
+    MappedShow mapped(CHECK_PATH);
+    FILE* file = fopen(CHECK_PATH, "rb");
+    StreamShow stream(readFile, file, rewindFile);
+    ShowSource* sources[] = {&memory, &mapped, &stream};
+    const char* names[] = {"memory", "mapped", "stream"};
+    LedWriter<3>* writers[4];
+    ShowPlayer<3>* players[3];
+    for (int i = 0; i < 4; ++i) {
+        writers[i] = new LedWriter<3>(std::array<uint8_t, 3>{}, 10, false);
+        writers[i]->scheduling = true;
+        writers[i]->run(0);
+    }
+    bool opened = (file != nullptr);
+    for (int i = 0; i < 3; ++i) {
+        players[i] = new ShowPlayer<3>(writers[i], sources[i]);
+        opened = (players[i]->open() && opened);
+        players[i]->play();
+    }
+    if (!opened) {
+        fprintf(stderr, "Unable to open the recorded show\n");
+        return 1;
+    }
+    // The direct writer gets the late cue once its clock can place it
+    uint64_t span = (CHECK_LATE + 1000000);
+    queue(*writers[3]);
+    uint32_t mismatched[3] = {}, late = 0;
+    bool queuedLate = false;
+    for (uint64_t time = CHECK_TICK; time <= span; time += CHECK_TICK) {
+        if (!queuedLate && ((time + SHOW_HORIZON) > CHECK_LATE)) {
+            writers[3]->createEffectAbsolute({800, 100, 0}, .25, false, static_cast<uint32_t>(CHECK_LATE), 0, 0, 6, false, 0, curve);
+            queuedLate = true;
+        }
+        for (int i = 0; i < 3; ++i) {
+            players[i]->run();
+        }
+        for (int i = 0; i < 4; ++i) {
+            writers[i]->run(static_cast<uint32_t>(time));
+        }
+        for (int i = 0; i < 3; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                mismatched[i] += (writers[i]->channels[c]->value != writers[3]->channels[c]->value);
+            }
+        }
+        // Nothing may move between the last early cue and the late one
+        if ((time > 6000000) && (time < CHECK_LATE)) {
+            late += (writers[0]->channels[0]->value != 300);
+        }
+    }
+    bool passed = !late;
+    for (int i = 0; i < 3; ++i) {
+        printf("%-8s %u of %llu channel samples differ\n", names[i], mismatched[i], static_cast<unsigned long long>((span / CHECK_TICK) * 3));
+        passed = (passed && !mismatched[i] && !players[i]->run());
+    }
+    std::array<uint16_t, 3> final = {writers[0]->channels[0]->value, writers[0]->channels[1]->value, writers[0]->channels[2]->value};
+    printf("Late cue %s; output %u %u %u\n", (late ? "played early" : "held until due"), final[0], final[1], final[2]);
+    passed = (passed && (final[0] == 800) && (final[1] == 100) && (final[2] == 0));
+    printf("%s\n", (passed ? "PASS" : "FAIL"));
+    for (int i = 0; i < 3; ++i) {
+        delete players[i];
+    }
+    for (int i = 0; i < 4; ++i) {
+        delete writers[i];
+    }
+    mapped.close();
+    fclose(file);
+    remove(CHECK_PATH);
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,220 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Timecode chase check
+
+    Sends MIDI timecode over localhost UDP to a TimecodeChase on a
+    virtual clock: plays, locates while stopped, drops out, and jumps
+    while running. It checks how closely chased time tracks the source,
+    that a locate lands on the same state an ordinary writer reaches by
+    playing up to that time, and that a dropout freewheels and then
+    stops. It also checks drop-frame conversions and reports the cost
+    of a closed-form seek against replaying the show. Build on a host
+    with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/timecodeChase.cpp -o timecodeChase
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "TimecodeChase.h"
+
+#define CHASE_PORT      15004
+
+static uint64_t virtualNow = 1000000;
+
+uint64_t virtualClock() {
+    return virtualNow;
+}
+
+double seconds(std::chrono::steady_clock::time_point started) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+struct Source {
+    int descriptor;
+    sockaddr_in destination;
+    void send(const uint8_t* bytes, size_t size) {
+        sendto(descriptor, bytes, size, 0, reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+    }
+};
+
+std::vector<Keyframe<3>> keyframes() {
+    return {
+            {500000, {1023, 0, 0}, nullptr},
+            {3000000, {0, 1023, 0}, Easing::get(Easing::EASE_IN_OUT)},
+            {6000000, {0, 0, 1023}, Easing::get(Easing::CUBIC_OUT)}
+        };
+}
+
+uint64_t quarters(uint64_t count, uint8_t rate) {
+    // Exact show time of a quarter frame, rounded up as Timecode does
+    uint32_t perSecond = (4 * ((rate == Timecode::FPS_24) ? 24 : ((rate == Timecode::FPS_25) ? 25 : 30)));
+    uint64_t scaled = (count * ((rate == Timecode::FPS_2997_DROP) ? 1001000 : 1000000));
+    return ((scaled + perSecond - 1) / perSecond);
+}
+
+int64_t play(Source& source, TimecodeChase<3>& chase, uint64_t from, double duration, uint8_t rate) {
+    /* Sends quarter frames from a frame-aligned show time, advancing
+    the virtual clock alongside; returns the worst chase error seen
+    once the receiver has run for two frames. */
+    uint32_t count = (duration * (4e6 / Timecode::frameLength(rate)));
+    uint64_t started = virtualNow;
+    int64_t worst = 0;
+    Timecode timecode;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t show = (from + quarters(i, rate));
+        virtualNow = (started + quarters(i, rate));
+        if (!(i % 8)) {
+            timecode = Timecode::fromMicroseconds(show, rate);
+        }
+        uint8_t message[2] = {MTC_QUARTER_FRAME, Timecode::quarterFrame(timecode, (i % 8))};
+        source.send(message, sizeof(message));
+        usleep(20);
+        chase.run();
+        int64_t error = (static_cast<int64_t>(chase.position) - static_cast<int64_t>(show));
+        if ((i >= 8) && (std::abs(error) > std::abs(worst))) {
+            worst = error;
+        }
+    }
+    virtualNow = (started + quarters(count, rate));
+    return worst;
+}
+
+bool checkDropFrame() {
+    // Every frame of an hour maps to a distinct timecode and back again
+    uint64_t previous = 0;
+    for (uint64_t count = 0; count < 107892; ++count) {
+        uint64_t time = (((count * 1001000) + 29) / 30);
+        Timecode timecode = Timecode::fromMicroseconds(time, Timecode::FPS_2997_DROP);
+        if ((timecode.toMicroseconds() != time) || (count && (time <= previous))) {
+            return false;
+        }
+        if ((timecode.seconds == 0) && (timecode.minutes % 10) && (timecode.frames < 2)) {
+            return false;
+        }
+        previous = time;
+    }
+    Timecode last = Timecode::fromMicroseconds(((107892ULL * 1001000) + 29) / 30, Timecode::FPS_2997_DROP);
+    return ((last.hours == 1) && !last.minutes && !last.seconds && !last.frames);
+}
+
+int main() {
+    bool dropFrame = checkDropFrame();
+    printf("Drop-frame conversion %s\n", (dropFrame ? "passed" : "FAILED"));
+
+    LedWriter<3> writer(std::array<uint8_t, 3>{}, 10, false);
+    TimecodeReceiver receiver(virtualClock);
+    TimecodeChase<3> chase(&writer, &receiver);
+    chase.addTimeline(keyframes(), 1);
+    std::array<Oscillator, 3> oscillators;
+    oscillators[0].frequency = .5;
+    oscillators[0].amplitude = 1023;
+    chase.addGenerator(oscillators, 20, 4);
+    chase.addTimeline(keyframes(), 25, -1);
+    if (!receiver.begin(CHASE_PORT)) {
+        fprintf(stderr, "Unable to bind port %d\n", CHASE_PORT);
+        return 1;
+    }
+    Source source = {socket(AF_INET, SOCK_DGRAM, 0), {}};
+    source.destination.sin_family = AF_INET;
+    source.destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    source.destination.sin_port = htons(CHASE_PORT);
+
+    // Play from zero
+    int64_t playing = play(source, chase, 0, 3, Timecode::FPS_30);
+    bool played = (receiver.running && (std::abs(playing) <= Timecode::frameLength(Timecode::FPS_30)));
+    printf("Play %s: worst chase error %+lld us\n", (played ? "passed" : "FAILED"), static_cast<long long>(playing));
+
+    // Locate while stopped; compare with a writer that played up to the same point
+    Timecode target = {0, 0, 4, 15, Timecode::FPS_30};
+    uint8_t message[MTC_FULL_FRAME_SIZE];
+    virtualNow += 2000000;
+    source.send(message, Timecode::fullFrame(message, target));
+    usleep(1000);
+    chase.run();
+    LedWriter<3> reference(std::array<uint8_t, 3>{}, 10, false);
+    reference.run(0);
+    reference.createTimeline(keyframes(), 1);
+    auto started = std::chrono::steady_clock::now();
+    for (uint32_t now = 0; now <= target.toMicroseconds(); now += 1000) {
+        reference.run(now);
+    }
+    double replay = seconds(started);
+    bool located = (!receiver.running && (chase.position == target.toMicroseconds()));
+    for (int i = 0; i < 3; ++i) {
+        located &= (std::abs(reference.channels[i]->value - writer.channels[i]->value) <= 2);
+    }
+    printf(
+            "Locate %s: %u %u %u chased, %u %u %u replayed\n", (located ? "passed" : "FAILED"),
+            writer.channels[0]->value, writer.channels[1]->value, writer.channels[2]->value,
+            reference.channels[0]->value, reference.channels[1]->value, reference.channels[2]->value
+        );
+
+    // Resume, then lose the source
+    play(source, chase, target.toMicroseconds(), 1, Timecode::FPS_30);
+    uint64_t lastShow = chase.position;
+    uint32_t dropouts = receiver.dropouts;
+    virtualNow += (receiver.freewheel / 2);
+    chase.run();
+    bool freewheeling = (receiver.running && (chase.position > lastShow));
+    uint64_t freewheeled = (chase.position - lastShow);
+    virtualNow += receiver.freewheel;
+    chase.run();
+    bool stopped = (!receiver.running && ((receiver.dropouts - dropouts) == 1) && (chase.position <= lastShow));
+    printf(
+            "Dropout %s: freewheeled to +%llu us, stopped at %.3f s\n",
+            ((freewheeling && stopped) ? "passed" : "FAILED"),
+            static_cast<unsigned long long>(freewheeled), (chase.position * 1e-6)
+        );
+
+    // Start far from where it stopped, then jump back while running, at drop-frame rate
+    uint32_t seeks = receiver.seeks;
+    play(source, chase, Timecode::fromMicroseconds(90000000, Timecode::FPS_2997_DROP).toMicroseconds(), 2, Timecode::FPS_2997_DROP);
+    int64_t jumped = play(source, chase, Timecode::fromMicroseconds(40000000, Timecode::FPS_2997_DROP).toMicroseconds(), 1, Timecode::FPS_2997_DROP);
+    bool jumping = (((receiver.seeks - seeks) == 2) && (std::abs(jumped) <= Timecode::frameLength(Timecode::FPS_2997_DROP)));
+    printf("Jump %s: %u seeks, worst chase error %+lld us\n", (jumping ? "passed" : "FAILED"), (receiver.seeks - seeks), static_cast<long long>(jumped));
+    close(source.descriptor);
+
+    // Seek cost against replaying at 1 ms ticks
+    Random random(1);
+    uint32_t count = 1000000;
+    uint64_t checksum = 0;
+    started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        checksum += chase.evaluate(random.next() % 3600000000ULL)[0];
+    }
+    double seeking = seconds(started);
+    printf(
+            "Closed-form seek: %.0f ns (checksum %llu); replaying 4.5 s of show: %.0f us\n",
+            (seeking * 1e9 / count), static_cast<unsigned long long>(checksum), (replay * 1e6)
+        );
+    return ((dropFrame && played && located && freewheeling && stopped && jumping) ? 0 : 1);
+}
@@ -0,0 +1,266 @@
+/*
+ * ESPRESSIF MIT License
+ *
+ * Copyright (c) 2019 K Hughes Production, LLC
+ *
+ * Permission is hereby granted for use on ESPRESSIF SYSTEMS products only, in which case,
+ * it is free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software is furnished
+ * to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/*
+    UID index check
+
+    Drives a UidIndex directly and through a LedWriter with random
+    inserts, deletions, retimes and cancels by UID, and after every step
+    compares each UID's chain against a linear scan of what is queued
+    and scheduled. Covers backward-shift deletion across the table's
+    wrap, growth, the overflow-to-scan fallback and its recovery once
+    the queue drains, and re-keying of looped effects. Build on a host
+    with:
+
+        g++ -std=c++17 -O2 -Isrc src/[A-Z]*.cpp tools/uidIndex.cpp -o uidIndex
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "LedWriter.h"
+
+#define CHECK_UIDS      48 // UIDs drawn for random operations; small, so chains form
+#define CHECK_STEPS     4000
+#define CHECK_OVERFLOW  (1u << (UID_INDEX_MAX_BITS - 1)) // Distinct UIDs a full table holds
+
+Random rng(2019);
+
+bool chained(Effect<1>* head, const std::vector<Effect<1>*>& expected, uint32_t uid) {
+    // Walks the chain both ways and compares it, as a set, with the scan
+    std::vector<Effect<1>*> found;
+    Effect<1>* previous = nullptr;
+    for (Effect<1>* effect = head; effect != nullptr; effect = effect->uidNext) {
+        if ((effect->uid != uid) || (effect->uidPrevious != previous) || (found.size() > expected.size())) {
+            return false;
+        }
+        found.push_back(effect);
+        previous = effect;
+    }
+    std::vector<Effect<1>*> sorted = expected;
+    std::sort(found.begin(), found.end());
+    std::sort(sorted.begin(), sorted.end());
+    return (found == sorted);
+}
+
+std::vector<Effect<1>*> scan(const std::vector<Effect<1>*>& pool, uint32_t uid) {
+    std::vector<Effect<1>*> matches;
+    for (auto effect: pool) {
+        if (effect->uid == uid) {
+            matches.push_back(effect);
+        }
+    }
+    return matches;
+}
+
+std::vector<Effect<1>*> scan(LedWriter<1>& writer, uint32_t uid) {
+    std::vector<Effect<1>*> pool = writer.effects;
+    for (auto& entry: writer.scheduler->heap) {
+        pool.push_back(entry.effect);
+    }
+    return scan(pool, uid);
+}
+
+uint32_t homeSlot(uint32_t uid, uint32_t bits) {
+    // Mirrors UidIndex::home()
+    return ((uid * 2654435769u) >> (32 - bits));
+}
+
+bool checkTable() {
+    LedWriter<1> writer(std::array<uint8_t, 1>{}, 10, false);
+    UidIndex<1> index;
+    std::vector<Effect<1>*> live;
+    uint32_t mismatches = 0, grown = 0;
+    for (uint32_t step = 0; step < CHECK_STEPS; ++step) {
+        // Fill toward a few hundred effects, then drain, so the table grows and empties
+        bool filling = ((step % 1000) < 600);
+        if (live.empty() || (rng.below(100) < (filling ? 70 : 30))) {
+            Effect<1>* effect = new Effect<1>({0}, &writer.channels, &writer.now);
+            effect->uid = rng.below(CHECK_UIDS * ((step / 1000) + 1));
+            index.insert(effect);
+            live.push_back(effect);
+        } else {
+            uint32_t chosen = rng.below(live.size());
+            index.remove(live[chosen]);
+            delete live[chosen];
+            live.erase(live.begin() + chosen);
+        }
+        grown = std::max(grown, index.bits);
+        for (uint32_t uid = 0; uid < (CHECK_UIDS * 4); ++uid) {
+            mismatches += !chained(index.find(uid), scan(live, uid), uid);
+        }
+    }
+    for (auto effect: live) {
+        index.remove(effect);
+        delete effect;
+    }
+    bool emptied = (index.occupied == 0);
+    // A cluster at the last slot wraps to the first; deleting its head must shift the rest back
+    std::vector<uint32_t> clustered;
+    for (uint32_t uid = 1; clustered.size() < 3; ++uid) {
+        if (homeSlot(uid, index.bits) == ((1u << index.bits) - 1)) {
+            clustered.push_back(uid);
+        }
+    }
+    std::vector<Effect<1>*> cluster;
+    for (auto uid: clustered) {
+        Effect<1>* effect = new Effect<1>({0}, &writer.channels, &writer.now);
+        effect->uid = uid;
+        index.insert(effect);
+        cluster.push_back(effect);
+    }
+    index.remove(cluster[0]);
+    bool shifted = (
+            (index.find(clustered[0]) == nullptr)
+            && (index.find(clustered[1]) == cluster[1])
+            && (index.find(clustered[2]) == cluster[2])
+            && (index.slots[(1u << index.bits) - 1].head == cluster[1])
+            && (index.slots[0].head == cluster[2])
+        );
+    for (auto effect: cluster) {
+        index.remove(effect);
+        delete effect;
+    }
+    bool passed = (!mismatches && emptied && shifted && (grown > UID_INDEX_MIN_BITS));
+    printf(
+            "Table %s: %u chain mismatches over %u steps, grew to %u slots, "
+            "%s when emptied, wrapped cluster %s after deletion\n",
+            (passed ? "passed" : "FAILED"), mismatches, CHECK_STEPS, (1u << grown),
+            (emptied ? "unoccupied" : "still occupied"), (shifted ? "shifted back" : "broken")
+        );
+    return passed;
+}
+
+bool checkOverflow() {
+    // A standalone index gives up rather than exceed its largest table
+    LedWriter<1> writer(std::array<uint8_t, 1>{}, 10, false);
+    UidIndex<1> index;
+    std::vector<Effect<1>*> pool;
+    bool held = true;
+    for (uint32_t uid = 0; uid <= CHECK_OVERFLOW; ++uid) {
+        Effect<1>* effect = new Effect<1>({0}, &writer.channels, &writer.now);
+        effect->uid = uid;
+        bool inserted = index.insert(effect);
+        held &= ((uid < CHECK_OVERFLOW) ? inserted : !inserted);
+        pool.push_back(effect);
+    }
+    bool unlinked = true;
+    for (auto effect: pool) {
+        unlinked &= ((effect->uidNext == nullptr) && (effect->uidPrevious == nullptr));
+        delete effect;
+    }
+    bool gaveUp = (held && index.overflowed && !index.occupied && unlinked);
+    // A writer falls back to scanning, then indexes again once its queue drains
+    writer.run(0);
+    for (uint32_t uid = 0; uid <= CHECK_OVERFLOW; ++uid) {
+        writer.createEffect({static_cast<uint16_t>(uid & 1023)}, 0, false, 0, 0, 0, uid);
+    }
+    writer.createEffect({0}, 0, false, 0, 0, 0, 7);
+    bool scanning = writer.uidIndex->overflowed;
+    uint32_t mismatches = 0;
+    for (uint32_t uid: {0u, 7u, 1000u, CHECK_OVERFLOW, CHECK_OVERFLOW + 1}) {
+        mismatches += !chained(writer.findEffect(uid), scan(writer, uid), uid);
+    }
+    uint32_t time = 0;
+    while (writer.effectsQueued()) {
+        writer.run(time += 2);
+    }
+    bool recovered = !writer.uidIndex->overflowed;
+    Effect<1>* fresh = writer.createEffect({0}, 0, false, 0, 0, 0, 42);
+    recovered &= ((writer.uidIndex->find(42) == fresh) && (writer.findEffect(42) == fresh));
+    bool passed = (gaveUp && scanning && !mismatches && recovered);
+    printf(
+            "Overflow %s: table %s at %u UIDs; writer %s, %u scan mismatches, %s after draining\n",
+            (passed ? "passed" : "FAILED"), (gaveUp ? "gave up" : "misbehaved"), (CHECK_OVERFLOW + 1),
+            (scanning ? "scanning" : "still indexing"), mismatches,
+            (recovered ? "indexing again" : "not recovered")
+        );
+    return passed;
+}
+
+bool checkWriter() {
+    // Random creates, retimes, cancels and ticks, with scheduling and loops
+    LedWriter<1> writer(std::array<uint8_t, 1>{}, 10, false);
+    writer.scheduling = true;
+    writer.run(0);
+    uint32_t time = 0, mismatches = 0, miscounted = 0, retimed = 0, cancelled = 0;
+    for (uint32_t step = 0; step < CHECK_STEPS; ++step) {
+        uint32_t uid = (rng.below(CHECK_UIDS / 4) + 1), roll = rng.below(100);
+        if (roll < 40) {
+            static const int32_t loops[] = {0, 0, 0, 2, -1};
+            writer.createEffectAbsolute(
+                    {static_cast<uint16_t>(rng.below(1024))}, (rng.below(20) * 1e-3), false,
+                    (time + rng.below(200000)), 0, 0, uid, false, loops[rng.below(5)]
+                );
+        } else if (roll < 50) {
+            uint32_t expected = scan(writer, uid).size();
+            uint32_t found = writer.retimeEffects(uid, 5e-3, (time + rng.below(200000)));
+            miscounted += (found != expected);
+            retimed += found;
+        } else if (roll < 58) {
+            uint32_t expected = scan(writer, uid).size();
+            uint32_t found = writer.cancelEffects(uid);
+            miscounted += (found != expected);
+            cancelled += found;
+        } else {
+            writer.run(time += (rng.below(5000) + 1));
+        }
+        uint32_t highest = CHECK_UIDS;
+        for (auto effect: writer.effects) {
+            // Loops are re-keyed above every queued UID
+            highest = std::max(highest, effect->uid + 1);
+        }
+        for (uint32_t probe = 0; probe < highest; ++probe) {
+            mismatches += !chained(writer.findEffect(probe), scan(writer, probe), probe);
+        }
+    }
+    // A looped effect leaves its old UID for one above the last queued
+    LedWriter<1> looper(std::array<uint8_t, 1>{}, 10, false);
+    looper.run(0);
+    Effect<1>* looped = looper.createEffect({1023}, 1e-3, false, 0, 0, 0, 5, false, 2);
+    looper.createEffect({0}, 1e-3, false, 0, 0, 0, 9);
+    for (time = 0; (looped->uid == 5) && (time < 100000); time += 100) {
+        looper.run(time);
+    }
+    bool rekeyed = (
+            (looped->uid == 10) && (looper.findEffect(5) == nullptr)
+            && (looper.findEffect(10) == looped) && (looper.findEffect(9) != nullptr)
+        );
+    bool passed = (!mismatches && !miscounted && rekeyed && retimed && cancelled);
+    printf(
+            "Writer %s: %u chain mismatches and %u miscounts over %u steps "
+            "(%u retimed, %u cancelled), looped effect %s\n",
+            (passed ? "passed" : "FAILED"), mismatches, miscounted, CHECK_STEPS,
+            retimed, cancelled, (rekeyed ? "re-keyed" : "not re-keyed")
+        );
+    return passed;
+}
+
+int main() {
+    bool passed = checkTable();
+    passed &= checkOverflow();
+    passed &= checkWriter();
+    return (passed ? 0 : 1);
+}